@@ -0,0 +1,136 @@
+/*
+ *      Copyright 2016-2017 Riccardo Musso
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ *
+ *      File compile/LineTable.h
+ *
+*/
+
+#ifndef _SM__COMPILE__LINETABLE_H
+#define _SM__COMPILE__LINETABLE_H
+
+#include <vector>
+#include <cstddef>
+
+#include "sm/typedefs.h"
+
+namespace sm{
+    namespace compile{
+        // the code from 'pc' to the next mark comes from 'line' of 'source'.
+        struct LineMark_t {
+            size_t pc;
+            unsigned source;
+            unsigned line;
+        };
+
+        using LineMarks_t = std::vector<LineMark_t>;
+
+        /*
+         * pc -> (source, line) table of Runtime_t::code, filled by the
+         * compiler. Each mark is stored as the difference from the previous
+         * one: the pc delta, then the line delta (zig-zag) shifted left by
+         * one, with the lowest bit set when the source changes and the new
+         * source follows. All of them are LEB128 varints, so most marks
+         * take two bytes. It's only read when a pc must be shown.
+         */
+        class LineTable {
+        private:
+            ByteCode_t _data;
+            LineMark_t _last {0, 0, 0};
+
+            void _write(size_t value){
+                while(value >= 0x80){
+                    _data.push_back(static_cast<unsigned char>(value | 0x80));
+                    value >>= 7;
+                }
+                _data.push_back(static_cast<unsigned char>(value));
+            }
+
+            static size_t _read(const ByteCode_t& data, size_t& pos) noexcept{
+                size_t value = 0;
+                unsigned shift = 0;
+                while(pos != data.size()){
+                    unsigned char byte = data[pos++];
+                    value |= static_cast<size_t>(byte & 0x7F) << shift;
+                    if(!(byte & 0x80))
+                        break;
+                    shift += 7;
+                }
+                return value;
+            }
+
+            // decodes the mark at 'pos', after 'mark'.
+            static void _next(const ByteCode_t& data, size_t& pos, LineMark_t& mark) noexcept{
+                mark.pc += _read(data, pos);
+                size_t delta = _read(data, pos);
+                size_t zigzag = delta >> 1;
+                if(zigzag & 1)
+                    mark.line -= static_cast<unsigned>((zigzag >> 1) + 1);
+                else
+                    mark.line += static_cast<unsigned>(zigzag >> 1);
+                if(delta & 1)
+                    mark.source = static_cast<unsigned>(_read(data, pos));
+            }
+
+        public:
+            // marks must be added by increasing pc.
+            void add(const LineMark_t& mark){
+                if(mark.source == _last.source && mark.line == _last.line)
+                    return;
+
+                long long delta = static_cast<long long>(mark.line) - _last.line;
+                size_t zigzag = delta < 0 ? ((static_cast<size_t>(-delta -1) << 1) | 1)
+                        : static_cast<size_t>(delta) << 1;
+
+                _write(mark.pc - _last.pc);
+                _write((zigzag << 1) | (mark.source != _last.source));
+                if(mark.source != _last.source)
+                    _write(mark.source);
+                _last = mark;
+            }
+
+            // false if no line is known for 'pc'.
+            bool find(size_t pc, unsigned& source, unsigned& line) const noexcept{
+                LineMark_t mark {0, 0, 0};
+                size_t pos = 0;
+                bool found = false;
+
+                while(pos != _data.size()){
+                    _next(_data, pos, mark);
+                    if(mark.pc > pc)
+                        break;
+                    source = mark.source;
+                    line = mark.line;
+                    found = true;
+                }
+                return found;
+            }
+
+            const ByteCode_t& data() const noexcept{
+                return _data;
+            }
+
+            // replaces the table with an encoded one (see io/smc.h).
+            void assign(ByteCode_t data) noexcept{
+                _data = std::move(data);
+                _last = {0, 0, 0};
+                size_t pos = 0;
+                while(pos != _data.size())
+                    _next(_data, pos, _last);
+            }
+        };
+    }
+}
+
+#endif
@@ -41,25 +41,28 @@ namespace sm{
                     "END_BLOCK", "THROW_EXCEPTION", "RETURN", "RETURN_NULL",
                     "PUSH_INT_0", "PUSH_INT_1", "PUSH_NULL", "PUSH_THIS", "PUSH_BOX",
                     "PUSH_CLASS", "ITERATE", "IT_NEXT", "MAKE_SUPER", "DUP",
-                    "DUP1"
+                    "DUP1", "TO_VALUE"
                 },
 
-                nullptr,
+                (const char* []) {
+                    "CMP_JUMP_IF_NOT_F", "LOCAL_CMP_JUMP_IF_NOT_F", "LOCAL_OP",
+                    "LOCAL_ASSIGN_OP_POP", "LOCAL_INC_POP"
+                },
 
                 (const char* []) {
                     "END_BLOCKS", "PUSH_INTEGER", "PUSH_FLOAT", "PUSH_STRING",
                     "PUSH_INT_VALUE", "PUSH_REF", "JUMP_F", "JUMP_B", "JUMP_IF_F",
                     "JUMP_IF_B", "JUMP_IF_NOT_F", "JUMP_IF_NOT_B", "LOGIC_AND",
                     "LOGIC_OR", "ELVIS", "TRY", "CATCH", "FINALLY", "CALL_FUNCTION",
-                    "PERFORM_BRACING", "DEFINE_VAR", "DEFINE_GLOBAL_VAR", "DEFINE_NULL_VAR",
-                    "DEFINE_GLOBAL_NULL_VAR", "ASSIGN_NULL_POP", "FIND", "FIND_SUPER",
+                    "PERFORM_BRACING", "DEFINE_GLOBAL_VAR", "DEFINE_GLOBAL_NULL_VAR", "ASSIGN_NULL_POP", "FIND", "FIND_SUPER",
                     "MAKE_LIST", "MAKE_TUPLE", "FOREACH_CHECK", "SWITCH_CASE"
                 },
 
                 nullptr,
 
                 (const char* []) {
-                    "IMPORT"
+                    "IMPORT", "LOAD_LOCAL", "DEFINE_LOCAL", "DEFINE_NULL_LOCAL",
+                    "CALL_METHOD"
                 }
             };
 
@@ -88,9 +91,15 @@ namespace sm{
                 std::cout << std::dec;
             }
 
-            std::string instRepr(std::array<uint8_t, 5> inst) noexcept{
-                unsigned skip = inst[0] & 0x40 ? (inst[0] & 0x80 ? 4 : 2) : 0;
-                return std::string(opCodes[skip][inst[0] & 0x3F]);
+            std::string instRepr(uint8_t opcode) noexcept{
+                unsigned skip = opcode & 0x40 ? (opcode & 0x80 ? 4 : 2)
+                    : (opcode & 0x80 ? 1 : 0); // 1 for superinstructions
+                constexpr unsigned last[] = { MAX_OPCODE_1BYTE, MAX_SUPERINSTRUCTION,
+                    MAX_OPCODE_3BYTE, 0, INVALID_OPCODE -1 };
+
+                if(opcode > last[skip])
+                    return "INVALID_OPCODE";
+                return std::string(opCodes[skip][opcode & 0x3F]);
             }
         }
     }
@@ -31,7 +31,7 @@ namespace sm{
     namespace compile{
         namespace test{
             void print(const ByteCode_t& code);
-            std::string instRepr(std::array<uint8_t, 5> inst) noexcept;
+            std::string instRepr(uint8_t opcode) noexcept;
         }
 
         enum OpCode{
@@ -160,7 +160,12 @@ namespace sm{
             */
             DUP1,
 
-            MAX_OPCODE_1BYTE = DUP1,
+            /*
+             * if TOS is a reference, replaces it with the referenced object.
+            */
+            TO_VALUE,
+
+            MAX_OPCODE_1BYTE = TO_VALUE,
 
             // *** STATEMENTS WITH LENGTH = 3 BYTE (1 + 2, opcode + param):
 
@@ -287,13 +292,13 @@ namespace sm{
             PERFORM_BRACING,
 
             /*
-             * create a variable with name
+             * create a global variable with name
              * defined by 'param' and valued
              * TOS or null.
+             * (local variables are created by DEFINE_LOCAL
+             * and DEFINE_NULL_LOCAL)
             */
-            DEFINE_VAR,
             DEFINE_GLOBAL_VAR,
-            DEFINE_NULL_VAR,
             DEFINE_GLOBAL_NULL_VAR,
 
             /*
@@ -355,6 +360,42 @@ namespace sm{
 
             MAX_OPCODE_3BYTE = SWITCH_CASE,
 
+            // *** SUPERINSTRUCTIONS (never found in the bytecode):
+
+            /*
+             * Interpreter::decode() replaces some common sequences
+             * of instructions with one of these, which runs them in
+             * a single dispatch when the operands are integers.
+             * (see exec/interpreter/superOpCodes.h for their params)
+            */
+
+            /*
+             * <compare>; JUMP_IF_NOT_F
+            */
+            CMP_JUMP_IF_NOT_F = 0x80,
+
+            /*
+             * LOAD_LOCAL; <int or local>; <compare>; JUMP_IF_NOT_F
+            */
+            LOCAL_CMP_JUMP_IF_NOT_F,
+
+            /*
+             * LOAD_LOCAL; <int or local>; <math operator>
+            */
+            LOCAL_OP,
+
+            /*
+             * LOAD_LOCAL; <int or local>; <assign operator>; POP
+            */
+            LOCAL_ASSIGN_OP_POP,
+
+            /*
+             * LOAD_LOCAL; INC, DEC, POST_INC or POST_DEC; POP
+            */
+            LOCAL_INC_POP,
+
+            MAX_SUPERINSTRUCTION = LOCAL_INC_POP,
+
             // **** STATEMENTS WITH LENGTH = 5 Bytes (Opcode of 1 byte + param0 (2 bytes) + param1 (2 bytes))
 
             /*
@@ -363,6 +404,30 @@ namespace sm{
             */
             IMPORT = 0xC0,
 
+            /*
+             * pushes the reference of the local variable
+             * in slot 'param0' of the current frame.
+             * If the variable isn't defined yet (e.g. its
+             * declaration was skipped by a switch), it's
+             * searched by its name 'param1' like PUSH_REF.
+            */
+            LOAD_LOCAL,
+
+            /*
+             * create a local variable named 'param1'
+             * in slot 'param0' of the current frame,
+             * valued TOS or null, and push its reference.
+            */
+            DEFINE_LOCAL,
+            DEFINE_NULL_LOCAL,
+
+            /*
+             * calls the member named 'param0' of the object
+             * under the 'param1' arguments, like FIND followed
+             * by CALL_FUNCTION, but without creating a Method.
+            */
+            CALL_METHOD,
+
             INVALID_OPCODE,
 
             ASSIGN_START = ASSIGN_ADD,
@@ -371,6 +436,7 @@ namespace sm{
 
         static_assert (MAX_OPCODE_1BYTE < 0x40, "too many statements of size 1");
         static_assert (MAX_OPCODE_3BYTE >= 0x40 && MAX_OPCODE_3BYTE < 0x80, "too many statements of size 3");
+        static_assert (MAX_SUPERINSTRUCTION < 0xC0, "too many superinstructions");
         static_assert (INVALID_OPCODE <= 0x100, // not 0xff, because INVALID_OPCODE is equal to max +1
             "statement opcodes mustn't be longer than 1 Byte.");
     }
@@ -26,6 +26,7 @@
 
 #include "sm/error/error.h"
 #include "sm/compile/Statement.h"
+#include "sm/compile/LineTable.h"
 #include "sm/compile/defs.h"
 #include "sm/runtime/Object.h"
 #include "sm/typedefs.h"
@@ -41,7 +42,7 @@ namespace sm {
                 enum {
                     // ROUND:
                     _ROUND_START,
-                    EXPR_ROUND, FUNC_CALL, TUPLE, REF_CALL, IS_NULL_CALL,
+                    EXPR_ROUND, FUNC_CALL, METHOD_CALL, TUPLE, REF_CALL, IS_NULL_CALL,
                     SUPER_FIND_CALL, DEFAULT_ARGUMENT, SUPER_EXPR,
 
                     // ROUND.HEAD:
@@ -150,8 +151,8 @@ namespace sm {
                 }
 
                 inline bool ParInfo_t::canCommaIncrement() const noexcept{
-                    return parType == FUNC_CALL || parType == TUPLE || parType == BRACING
-                        || parType == LIST;
+                    return parType == FUNC_CALL || parType == METHOD_CALL || parType == TUPLE
+                        || parType == BRACING || parType == LIST;
                 }
 
                 inline bool ParInfo_t::isCodeBlock() const noexcept{
@@ -166,6 +167,15 @@ namespace sm {
                 std::vector<ParType::Operator_t> operators;
                 std::vector<unsigned> toImportAll;
 
+                // name ids of the current function's locals (the index is the slot)
+                std::vector<unsigned> locals;
+                // locals.size() when each block was opened
+                std::vector<size_t> localBlocks;
+
+                // where the last FIND ends, to turn 'a.b(...)' into CALL_METHOD
+                const ByteCode_t* findOutput = nullptr;
+                size_t findEnd = 0;
+
                 ByteCode_t* output;
                 ImportsVec_t* toImport;
                 Box* currBox = nullptr;
@@ -188,6 +198,9 @@ namespace sm {
                 ByteCode_t _temp; // Used for <init>
                 ByteCode_t _classTemp; // Used for classes' <init>
 
+                // lines of the code in Runtime_t::code (not yet in Runtime_t::lines), _temp and _classTemp
+                LineMarks_t _codeLines, _tempLines, _classTempLines;
+
 
                 StringsMap_t _strings;
                 IntsMap_t _ints;
@@ -196,10 +209,16 @@ namespace sm {
                 unsigned _nfile;
 
                 void _ultimateToken(CompilerStates& states);
+                void _markLine(CompilerStates& states);
+                void _appendCode(ByteCode_t& code, LineMarks_t& lines);
                 void _globalScopeCompile(CompilerStates& states);
                 void _localScopeCompile(CompilerStates& states);
                 void _operatorsCompile(CompilerStates& states);
                 void _declareVar(CompilerStates& states, ByteCode_t& out, bool global);
+                void _startBlock(CompilerStates& states);
+                void _endBlock(CompilerStates& states);
+                void _defineLocal(CompilerStates& states, ByteCode_t& out, unsigned idx, bool null);
+                bool _findLocal(const CompilerStates& states, unsigned idx, unsigned& slot);
 
                 void _compile(const parse::TokenVec_t& tokens);
             public:
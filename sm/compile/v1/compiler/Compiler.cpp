@@ -49,6 +49,17 @@ namespace sm{
         namespace v1 {
             using namespace ParType;
 
+            namespace {
+                // the code emitted from now on in a buffer of size 'pc' comes from 'line'.
+                void markLine(LineMarks_t& marks, size_t pc, unsigned source, unsigned line){
+                    // no code was emitted since the last marks (or it was removed)
+                    while(!marks.empty() && marks.back().pc >= pc)
+                        marks.pop_back();
+                    if(marks.empty() || marks.back().source != source || marks.back().line != line)
+                        marks.push_back({pc, source, line});
+                }
+            }
+
             Compiler::Compiler(runtime::Runtime_t& rt)
                 : _rt(&rt), _nfile(0){}
 
@@ -247,6 +258,22 @@ namespace sm{
                 }
             }
 
+            void Compiler::_markLine(CompilerStates& states){
+                markLine(_codeLines, _rt->code.size(), _nfile, states.it->ln);
+                markLine(_tempLines, _temp.size(), _nfile, states.it->ln);
+                markLine(_classTempLines, _classTemp.size(), _nfile, states.it->ln);
+            }
+
+            void Compiler::_appendCode(ByteCode_t& code, LineMarks_t& lines){
+                size_t base = _rt->code.size();
+                _rt->code.insert(_rt->code.end(), code.begin(), code.end());
+                for(const LineMark_t& mark : lines)
+                    markLine(_codeLines, base + mark.pc, mark.source, mark.line);
+
+                code.clear();
+                lines.clear();
+            }
+
             void Compiler::_compile(const parse::TokenVec_t& tokens){
                 ImportsVec_t toImport;
                 CompilerStates states;
@@ -264,6 +291,7 @@ namespace sm{
                 it = tokens.begin();
 
                 while(true){
+                    _markLine(states);
                     _ultimateToken(states);
                     if(states.parStack.empty()){
                         _globalScopeCompile(states);
@@ -297,10 +325,14 @@ namespace sm{
                         });
                     }
 
-                    _rt->code.insert(_rt->code.end(), _temp.begin(), _temp.end()); // inserting <init> code
+                    _appendCode(_temp, _tempLines); // inserting <init> code
                     _rt->code.push_back(RETURN_NULL);
-                    _temp.clear();
                 }
+
+                for(const LineMark_t& mark : _codeLines)
+                    _rt->lines.add(mark);
+                _codeLines.clear();
+                _tempLines.clear();
             }
 
             void Compiler::_declareVar(CompilerStates& states, ByteCode_t& out, bool global){
@@ -333,24 +365,86 @@ namespace sm{
                                 "multiple var definition is not allowed in bigger expressions.");
                         }
 
-                        out.insert(out.end(), {
-                            bc(global ? DEFINE_GLOBAL_NULL_VAR : DEFINE_NULL_VAR),
-                            bc(idx >> 8), bc(idx & 0xFF), POP
-                        });
+                        if(global){
+                            out.insert(out.end(), {
+                                DEFINE_GLOBAL_NULL_VAR, bc(idx >> 8), bc(idx & 0xFF)
+                            });
+                        } else {
+                            _defineLocal(states, out, idx, true);
+                        }
+                        out.push_back(POP);
                         states.isLastOperand = true;
                         continue;
                     } else {
                         --it;
-                        out.insert(out.end(), {
-                            bc(global ? DEFINE_GLOBAL_NULL_VAR : DEFINE_NULL_VAR),
-                            bc(idx >> 8), bc(idx & 0xFF)
-                        });
+                        if(global){
+                            out.insert(out.end(), {
+                                DEFINE_GLOBAL_NULL_VAR, bc(idx >> 8), bc(idx & 0xFF)
+                            });
+                        } else {
+                            _defineLocal(states, out, idx, true);
+                        }
                         states.isLastOperand = true;
                         break;
                     }
                 }
             }
 
+            void Compiler::_startBlock(CompilerStates& states){
+                states.output->push_back(START_BLOCK);
+                states.localBlocks.push_back(states.locals.size());
+            }
+
+            void Compiler::_endBlock(CompilerStates& states){
+                states.output->push_back(END_BLOCK);
+                if(!states.localBlocks.empty()){
+                    states.locals.resize(states.localBlocks.back());
+                    states.localBlocks.pop_back();
+                }
+            }
+
+            /*
+             * gives a slot to the local named 'idx' (reusing the one of the
+             * same block, so that a redeclaration is still detected at runtime)
+             * and writes DEFINE_LOCAL or DEFINE_NULL_LOCAL.
+             */
+            void Compiler::_defineLocal(CompilerStates& states, ByteCode_t& out, unsigned idx, bool null){
+                size_t first = states.localBlocks.empty() ? 0 : states.localBlocks.back();
+                size_t slot = states.locals.size();
+
+                for(size_t i = first; i != states.locals.size(); ++i){
+                    if(states.locals[i] == idx){
+                        slot = i;
+                        break;
+                    }
+                }
+
+                if(slot == states.locals.size()){
+                    if(slot > 0xFFFF){
+                        parse::TokenVec_t::const_iterator& it = states.it;
+                        _rt->sources.msg(error::ET_ERROR, _nfile, it->ln, it->ch,
+                            "too many local variables in this function.");
+                    }
+                    states.locals.push_back(idx);
+                }
+
+                out.insert(out.end(), {
+                    bc(null ? DEFINE_NULL_LOCAL : DEFINE_LOCAL),
+                    bc(slot >> 8), bc(slot & 0xFF),
+                    bc(idx >> 8), bc(idx & 0xFF)
+                });
+            }
+
+            bool Compiler::_findLocal(const CompilerStates& states, unsigned idx, unsigned& slot){
+                for(size_t i = states.locals.size(); i != 0; --i){
+                    if(states.locals[i-1] == idx){
+                        slot = i-1;
+                        return true;
+                    }
+                }
+                return false;
+            }
+
             bool Compiler::load_native(const char* path, runtime::Runtime_t& rt, unsigned id, Box*& box) noexcept{
                 #ifdef _SM_OS_WINDOWS
                     HMODULE library = LoadLibraryA(path);
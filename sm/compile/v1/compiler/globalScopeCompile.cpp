@@ -235,6 +235,8 @@ namespace sm{
                         fn->address = states.output->size();
                         fn->boxName = states.currBox->name;
                         fn->fnName = id;
+                        states.locals.clear();
+                        states.localBlocks.clear();
 
                         if(states.currClass)
                             states.currClass->objects.insert({id, RootObject(makeFunction(fn))});
@@ -273,9 +275,11 @@ namespace sm{
                                         ASSIGN_NULL_POP, bc(name_id >> 8), bc(name_id & 0xFF)
                                     });
                                     fn->arguments.emplace_back(arg_id, states.output->size());
+                                    states.locals.push_back(name_id);
                                     if(roundClose)
                                         break;
                                 } else if(it->type == TT_ASSIGN){
+                                    states.locals.push_back(arg_id - runtime::idsStart);
                                     it -= 2;
                                     arg0 = arg_id;
                                     break;
@@ -300,6 +304,7 @@ namespace sm{
                                     }
 
                                     fn->arguments.emplace_back(arg_id, states.output->size());
+                                    states.locals.push_back(arg_id - runtime::idsStart);
                                     fn->flags = FF_VARARGS;
                                     roundClose = true;
                                     break;
@@ -432,9 +437,8 @@ namespace sm{
 
                                 // inserting init code into bytecode and linking it to the class
                                 states.currClass->objects.insert({runtime::initId, RootObject(makeFunction(fn))});
-                                _rt->code.insert(_rt->code.end(), _classTemp.begin(), _classTemp.end());
+                                _appendCode(_classTemp, _classTempLines);
                                 _rt->code.push_back(RETURN_NULL);
-                                _classTemp.clear();
                             }
 
                             states.currClass = nullptr;
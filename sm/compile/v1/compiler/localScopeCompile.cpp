@@ -56,13 +56,23 @@ namespace sm{
                             states.output->insert(states.output->end(), {
                                 FIND, bc(idx >> 8), bc(idx & 0xFF)
                             });
+                            states.findOutput = states.output;
+                            states.findEnd = states.output->size();
                             states.isLastDot = false;
                             break;
                         }
 
-                        states.output->insert(states.output->end(), {
-                            PUSH_REF, bc(idx >> 8), bc(idx & 0xFF)
-                        });
+                        unsigned slot;
+                        if(_findLocal(states, idx, slot)){
+                            states.output->insert(states.output->end(), {
+                                LOAD_LOCAL, bc(slot >> 8), bc(slot & 0xFF),
+                                bc(idx >> 8), bc(idx & 0xFF)
+                            });
+                        } else {
+                            states.output->insert(states.output->end(), {
+                                PUSH_REF, bc(idx >> 8), bc(idx & 0xFF)
+                            });
+                        }
                         break;
                     }
 
@@ -191,7 +201,7 @@ namespace sm{
                         }
 
                         states.parStack.back().arg0 = states.output->size();
-                        states.output->push_back(START_BLOCK);
+                        _startBlock(states);
                         states.isStatementEmpty = true;
                         states.isLastOperand = false;
                         break;
@@ -210,10 +220,8 @@ namespace sm{
                                 unsigned nid = runtime::genOrdinaryId(*_rt, it->content) - runtime::idsStart;
                                 if((++it)->type == TT_COLON){
                                     states.parStack.emplace_back(FOREACH_HEAD);
-                                    states.output->insert(states.output->end(), {
-                                        START_BLOCK,
-                                        DEFINE_NULL_VAR, bc(nid >> 8), bc(nid & 0xFF)
-                                    });
+                                    _startBlock(states);
+                                    _defineLocal(states, *states.output, nid, true);
 
                                     states.isStatementEmpty = true;
                                     states.isLastOperand = false;
@@ -226,7 +234,7 @@ namespace sm{
 
                         // NORMAL FOR
                         states.parStack.emplace_back(FOR_HEAD1);
-                        states.output->push_back(START_BLOCK);
+                        _startBlock(states);
                         states.isStatementEmpty = true;
                         states.isLastOperand = false;
                         break;
@@ -584,7 +592,26 @@ namespace sm{
                     }
 
                     case TT_ROUND_OPEN:{
-                        states.parStack.emplace_back(states.isLastOperand ? FUNC_CALL : EXPR_ROUND);
+                        /*
+                         * 'obj.name(...)': FIND is dropped and CALL_METHOD will do
+                         * the lookup without creating a Method object. The receiver
+                         * is resolved by TO_VALUE before the arguments run, so
+                         * 'a.f(a = b)' still calls 'f' on the old 'a'.
+                         */
+                        if(states.isLastOperand && (it-1)->type == TT_TEXT
+                                && states.findOutput == states.output
+                                && states.findEnd == states.output->size()){
+                            size_t size = states.output->size();
+                            unsigned idx = ((*states.output)[size-2] << 8) | (*states.output)[size-1];
+
+                            states.output->resize(size -3);
+                            states.output->push_back(TO_VALUE);
+                            states.findOutput = nullptr;
+                            states.parStack.emplace_back(METHOD_CALL);
+                            states.parStack.back().arg1 = idx;
+                        } else {
+                            states.parStack.emplace_back(states.isLastOperand ? FUNC_CALL : EXPR_ROUND);
+                        }
                         states.operators.emplace_back(it->type, it->i);
                         states.isLastOperand = false;
                         break;
@@ -607,7 +634,7 @@ namespace sm{
                             states.parStack.emplace_back(CODE_BLOCK);
                             states.isLastOperand = false;
                             states.isStatementEmpty = true;
-                            states.output->push_back(START_BLOCK);
+                            _startBlock(states);
                         }
                         break;
                     }
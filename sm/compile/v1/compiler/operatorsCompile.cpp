@@ -68,7 +68,7 @@ namespace sm{
 
                         for (ParStack_t::const_reverse_iterator it = states.parStack.rbegin();
                                 it != states.parStack.rend(); ++it){
-                            if(it->parType == FUNC_CALL || it->parType == TUPLE
+                            if(it->parType == FUNC_CALL || it->parType == METHOD_CALL || it->parType == TUPLE
                                     || it->parType == REF_CALL || it->parType == IS_NULL_CALL
                                     || it->parType == SUPER_FIND_CALL){
                                 closing = TT_ROUND_OPEN;
@@ -305,10 +305,13 @@ namespace sm{
                                         size_t idx = back.arg0;
                                         bool isGlobal = back.parType == GLOBAL_VAR_DECL;
 
-                                        states.output->insert(states.output->end(), {
-                                            bc(isGlobal ? DEFINE_GLOBAL_VAR : DEFINE_VAR),
-                                            bc(idx >> 8), bc(idx & 0xFF)
-                                        });
+                                        if(isGlobal){
+                                            states.output->insert(states.output->end(), {
+                                                DEFINE_GLOBAL_VAR, bc(idx >> 8), bc(idx & 0xFF)
+                                            });
+                                        } else {
+                                            _defineLocal(states, *states.output, idx, false);
+                                        }
                                         states.parStack.pop_back();
 
                                         if(isGlobal){
@@ -426,7 +429,7 @@ namespace sm{
                         if(doPop)
                             states.output->push_back(POP);
                         if(doEndBlock)
-                            states.output->push_back(END_BLOCK);
+                            _endBlock(states);
                         if(!closing && !closingSpecial && it->type != TT_SEMICOLON
                                 && it->type != TT_COMMA)
                             states.operators.emplace_back(it->type, it->i);
@@ -506,6 +509,15 @@ namespace sm{
                                 states.output->insert(states.output->end(), {
                                     CALL_FUNCTION, bc(info.arg0 >> 8), bc(info.arg0 & 0xFF)
                                 });
+                            } else if(info.parType == METHOD_CALL){
+                                // without arguments nothing can change the receiver first.
+                                if(info.arg0 == 0 && states.output->back() == TO_VALUE)
+                                    states.output->pop_back();
+
+                                states.output->insert(states.output->end(), {
+                                    CALL_METHOD, bc(info.arg1 >> 8), bc(info.arg1 & 0xFF),
+                                    bc(info.arg0 >> 8), bc(info.arg0 & 0xFF)
+                                });
                             } else if(info.parType == BRACING){
                                 states.output->insert(states.output->end(), {
                                     PERFORM_BRACING, bc(info.arg0 >> 8), bc(info.arg0 & 0xFF)
@@ -600,9 +612,8 @@ namespace sm{
 
                                 // inserting init code into bytecode and linking it to the class
                                 states.currClass->objects.insert({runtime::initId, RootObject(makeFunction(fn))});
-                                _rt->code.insert(_rt->code.end(), _classTemp.begin(), _classTemp.end());
+                                _appendCode(_classTemp, _classTempLines);
                                 _rt->code.push_back(RETURN_NULL);
-                                _classTemp.clear();
                             }
                             states.currClass = nullptr;
                             states.isClassStatement = false;
@@ -621,9 +632,8 @@ namespace sm{
 
                                             // inserting init code into bytecode and linking it to the class
                                             states.currClass->objects.insert({runtime::initId, RootObject(makeFunction(fn))});
-                                            _rt->code.insert(_rt->code.end(), _classTemp.begin(), _classTemp.end());
+                                            _appendCode(_classTemp, _classTempLines);
                                             _rt->code.push_back(RETURN_NULL);
-                                            _classTemp.clear();
                                         }
                                         states.currClass = nullptr;
                                         states.isClassStatement = false;
@@ -632,7 +642,7 @@ namespace sm{
 
                                     closingSpecial = info.parType - (_STATEMENTS_START - _CURLY_START);
                                     if(closingSpecial != FUNCTION_BODY)
-                                        states.output->push_back(END_BLOCK);
+                                        _endBlock(states);
                                 }
 
                                 switch(closingSpecial){
@@ -652,7 +662,7 @@ namespace sm{
                                         });
 
                                         info.arg0 = states.output->size() -2;
-                                        states.output->push_back(START_BLOCK);
+                                        _startBlock(states);
                                         states.isStatementEmpty = true;
                                         states.isLastOperand = false;
                                         break;
@@ -674,7 +684,7 @@ namespace sm{
                                         });
 
                                         info.arg1 = states.output->size() -2;
-                                        states.output->push_back(START_BLOCK);
+                                        _startBlock(states);
 
                                         states.isStatementEmpty = true;
                                         states.isLastOperand = false;
@@ -744,7 +754,7 @@ namespace sm{
                                             --it;
                                         }
 
-                                        states.output->push_back(START_BLOCK);
+                                        _startBlock(states);
                                         states.isStatementEmpty = true;
                                         states.isLastOperand = false;
                                         break;
@@ -770,7 +780,7 @@ namespace sm{
                                             (*states.output)[label] = (diff >> 8) & 0xFF;
                                             (*states.output)[label+1] = diff & 0xFF;
 
-                                            states.output->push_back(START_BLOCK);
+                                            _startBlock(states);
                                             states.isStatementEmpty = true;
                                             states.isLastOperand = false;
                                         } else {
@@ -874,15 +884,15 @@ namespace sm{
                                         states.output->insert(states.output->end(), {
                                             ITERATE,
                                             IT_NEXT,
-                                            FOREACH_CHECK, 0, 0,
-                                            START_BLOCK
+                                            FOREACH_CHECK, 0, 0
                                         });
 
                                         // FOREACH_CHECK's 'param' address
-                                        info.arg1 = states.output->size() -3;
+                                        info.arg1 = states.output->size() -2;
 
                                         // IT_NEXT address -2 (FOR_BODY adds 2)
-                                        info.arg2 = states.output->size() -7;
+                                        info.arg2 = states.output->size() -6;
+                                        _startBlock(states);
 
                                         states.isStatementEmpty = true;
                                         states.isLastOperand = false;
@@ -935,7 +945,7 @@ namespace sm{
                                         (*states.output)[label] = (diff >> 8) & 0xFF;
                                         (*states.output)[label+1] = diff & 0xFF;
 
-                                        states.output->push_back(START_BLOCK);
+                                        _startBlock(states);
 
                                         states.isStatementEmpty = true;
                                         states.isLastOperand = false;
@@ -982,7 +992,7 @@ namespace sm{
                                             info.loopStatements = nullptr;
                                         }
 
-                                        states.output->push_back(END_BLOCK);
+                                        _endBlock(states);
                                         states.parStack.pop_back();
                                         states.isStatementEmpty = true;
                                         states.isLastOperand = false;
@@ -1088,10 +1098,12 @@ namespace sm{
                                                         states.output->push_back((name_id >> 8) & 0xFF);
                                                         states.output->push_back(name_id & 0xFF);
                                                         fn->arguments.push_back(std::make_pair(arg_id, states.output->size()));
+                                                        states.locals.push_back(name_id);
                                                         if(roundClose)
                                                             break;
                                                     } else if(it->type == TT_ASSIGN){
                                                         states.parStack.back().arg0 = arg_id;
+                                                        states.locals.push_back(arg_id - runtime::idsStart);
                                                         break;
                                                     } else if(it->type == TT_DOT){
                                                             /* three varargs dots!*/
@@ -1114,6 +1126,7 @@ namespace sm{
                                                         }
 
                                                         fn->arguments.push_back(std::make_pair(arg_id, states.output->size()));
+                                                        states.locals.push_back(arg_id - runtime::idsStart);
                                                         fn->flags = FF_VARARGS;
                                                         roundClose = true;
                                                         break;
@@ -1148,6 +1161,8 @@ namespace sm{
 
                                     case FUNCTION_BODY: {
                                         states.output->push_back(RETURN_NULL);
+                                        states.locals.clear();
+                                        states.localBlocks.clear();
                                         states.parStack.pop_back();
                                         states.isStatementEmpty = true;
                                         states.isLastOperand = false;
@@ -110,7 +110,13 @@ namespace sm{
 
             if(it->thisObject->type == ObjectType::CLASS_INSTANCE && it->thisObject->i_ptr->base)
                 std::cerr << intp.rt->nameFromId(it->thisObject->i_ptr->base->name) << "::";
-            std::cerr << intp.rt->nameFromId(it->function->fnName) << "()" << std::endl;
+            std::cerr << intp.rt->nameFromId(it->function->fnName) << "()";
+
+            // the pc of the other frames was saved when they made their call.
+            std::string location = intp.rt->location(it == intp.funcStack.rbegin() ? intp.pc : it->pc);
+            if(!location.empty())
+                std::cerr << " (" << location << ")";
+            std::cerr << std::endl;
 
             if(it->inlined){
                 std::cerr <<  "\tat <native>(...)" << std::endl;
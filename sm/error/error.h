@@ -55,6 +55,7 @@ namespace sm {
     public:
         unsigned newSource(error::CodeSource* src) noexcept;
         error::CodeSource* getSource(unsigned id) noexcept;
+        size_t size() const noexcept { return _sources.size(); }
 
         void msg(const std::string& msg) noexcept;
         void msg(enum_t errType, unsigned source, unsigned ln, unsigned ch, const std::string& msg) noexcept;
@@ -20,16 +20,77 @@
 #ifndef _SM__EXEC__INTERPRETER_H
 #define _SM__EXEC__INTERPRETER_H
 
+#include <deque>
+#include <memory>
+
 #include "sm/runtime/Object.h"
 #include "sm/runtime/gc.h"
+#include "sm/exec/Profiler.h"
 
 namespace sm{
     namespace exec{
+        struct LocalSlot_t {
+            RootObject obj;
+            unsigned name = 0; // to search the variable by name
+            bool defined = false;
+        };
+
+        /*
+         * a deque doesn't move its elements when it grows,
+         * so the references to the locals stay valid.
+         */
+        using LocalsStack_t = std::deque<LocalSlot_t>;
+
+        // FIND or PUSH_REF without an inline cache (see Interpreter::decode()).
+        constexpr unsigned noCache = 0xFFFF;
+
+        /*
+         * inline cache of a FIND or PUSH_REF instruction: where the name
+         * was found for the last owners seen. The owner is the Shape and
+         * the Class of an instance (or of 'this' for PUSH_REF, both nullptr
+         * outside methods), or a Box.
+         */
+        struct MemberCache_t {
+            struct Entry_t {
+                const void* owner = nullptr;
+                const Class* base = nullptr;
+                Object* member = nullptr; // nullptr if it's a field
+                unsigned field = 0; // index in Instance::fields
+                bool bind = false; // if functions are bound to the instance
+                bool used = false;
+            };
+
+            std::array<Entry_t, 2> entries;
+            unsigned next = 0; // the entry to replace
+
+            inline const Entry_t* lookup(const void* owner, const Class* base) const noexcept{
+                for(const Entry_t& entry : entries)
+                    if(entry.used && entry.owner == owner && entry.base == base)
+                        return &entry;
+                return nullptr;
+            }
+
+            inline void store(const void* owner, const Class* base, Object* member,
+                    unsigned field, bool bind) noexcept{
+                Entry_t& entry = entries[next];
+                next = (next +1) % entries.size();
+                entry.owner = owner;
+                entry.base = base;
+                entry.member = member;
+                entry.field = field;
+                entry.bind = bind;
+                entry.used = true;
+            }
+        };
+
+        using MemberCacheVec_t = std::vector<MemberCache_t>;
+
         struct CallInfo_t {
             /*
             * note: for each change in CallInfo_t, GC must be updated.
             */
-            RootObjectDictVec_t codeBlocks;
+            size_t localsBase = 0; // slot 0 in Interpreter::locals
+            size_t blocksBase = 0; // first block in Interpreter::blocks
             RootObject thisObject; // 'this' object
             Function* function = nullptr; // for Stack Trace
             Box* box = nullptr;
@@ -50,41 +111,64 @@ namespace sm{
         public:
             RootObjectVec_t exprStack;
             CallStack_t funcStack;
+            LocalsStack_t locals;
+            // for each open block, the size of 'locals' when it was opened.
+            std::vector<size_t> blocks;
+            // indexed by the cache id given to each FIND and PUSH_REF.
+            MemberCacheVec_t caches;
             // funcStack is shared between GC and Interpreter
             runtime::Runtime_t* rt;
+            runtime::Region* region; // where its instances are made
+            // Runtime_t::opProfile for the main interpreter, ownProfile for the others.
+            OpProfile_t* profile = nullptr;
+            std::unique_ptr<OpProfile_t> ownProfile;
+            // set by the StackSampler, the call stack is recorded before the next instruction.
+            std::atomic_bool sampleNow;
             unsigned pc;
             bool doReturn;
 
-            explicit Interpreter(runtime::Runtime_t& _rt) : rt(&_rt), pc(0), doReturn(false) {
+            explicit Interpreter(runtime::Runtime_t& _rt) : rt(&_rt), region(_rt.gc.takeRegion()),
+                    sampleNow(false), pc(0), doReturn(false) {
                 exprStack.reserve(_rt.min_ss);
             }
 
             Interpreter(const Interpreter&) = delete;
-            Interpreter(Interpreter&&) = default;
+            Interpreter(Interpreter&&) = delete;
 
             Interpreter& operator=(const Interpreter&) = delete;
-            Interpreter& operator=(Interpreter&&) = default;
+            Interpreter& operator=(Interpreter&&) = delete;
 
             RootObject callFunction(Function* fn, const RootObjectVec_t& args = RootObjectVec_t(),
                 const RootObject& self = RootObject(), bool inlined = false);
             void makeCall(Function* fn, const RootObjectVec_t& args = RootObjectVec_t(),
                 const RootObject& self = RootObject(), bool inlined = false);
+            /*
+             * like makeCall(), but the arguments are the top 'n_args' objects
+             * of exprStack: they're removed from it together with the callee
+             * below them and, when calling Smudge code, moved straight into
+             * the new frame's locals.
+             */
+            void makeStackCall(Function* fn, unsigned n_args, const RootObject& self);
             RootObject start();
             void printStackContent();
 
-            inline std::array<uint8_t, 5> fetch(unsigned& addr){
-                std::array<uint8_t, 5> ret {};
-                uint8_t opcode = ret[0] = rt->code[addr++];
-                if(opcode & 0x40){
-                    ret[1] = rt->code[addr++];
-                    ret[2] = rt->code[addr++];
-                    if(opcode & 0x80){
-                        ret[3] = rt->code[addr++];
-                        ret[4] = rt->code[addr++];
-                    }
-                }
-                return ret;
-            }
+        private:
+            /*
+             * fills Runtime_t::threadedCode, 'labels' are the
+             * addresses of the handlers indexed by opcode.
+             * FIND, PUSH_REF and CALL_METHOD get their inline cache id in inst[5..6],
+             * then some sequences are replaced with superinstructions.
+             */
+            void decode(const void* const* labels);
+            /*
+             * pushes the CallInfo_t of 'fn', whose first 'n_args' locals
+             * (from 'localsBase') have already been filled with the arguments.
+             */
+            void enterFrame(Function* fn, size_t localsBase, size_t n_args,
+                const RootObject& self, bool inlined);
+            void stackOverflow();
+            void sampleStack();
+        public:
 
             ~Interpreter();
         };
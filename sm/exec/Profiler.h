@@ -0,0 +1,124 @@
+/*
+ *      Copyright 2016-2017 Riccardo Musso
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ *
+ *      File exec/Profiler.h
+ *
+*/
+
+#ifndef _SM__EXEC__PROFILER_H
+#define _SM__EXEC__PROFILER_H
+
+#include <array>
+#include <vector>
+#include <map>
+#include <string>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#   include <intrin.h>
+#   define _SM_PROFILER_CYCLES
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#   define _SM_PROFILER_CYCLES
+#endif
+
+namespace sm{
+    namespace runtime{
+        class Runtime_t;
+    }
+
+    namespace exec{
+        /*
+         * counters of the opcode profiler (option -P): executions of
+         * each opcode, of each pair of consecutive opcodes and the ticks
+         * (CPU cycles where available) spent in each opcode.
+         */
+        struct OpProfile_t {
+            std::array<uint64_t, 256> counts {};
+            std::array<uint64_t, 256> ticks {};
+            std::vector<uint64_t> pairs; // [previous opcode * 256 + opcode]
+            std::mutex merge_m;
+            uint64_t lastTick = 0;
+            uint8_t last = 0;
+            bool hasLast = false;
+
+            OpProfile_t() : pairs(256 * 256, 0) {}
+
+            static inline uint64_t tick() noexcept{
+                #if defined(_SM_PROFILER_CYCLES) && defined(_MSC_VER)
+                    return __rdtsc();
+                #elif defined(_SM_PROFILER_CYCLES)
+                    return __builtin_ia32_rdtsc();
+                #else
+                    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch()).count();
+                #endif
+            }
+
+            // called before running each instruction.
+            inline void record(uint8_t opcode) noexcept{
+                uint64_t now = tick();
+                if(hasLast){
+                    ticks[last] += now - lastTick;
+                    ++pairs[last * 256 + opcode];
+                }
+                ++counts[opcode];
+                last = opcode;
+                lastTick = now;
+                hasLast = true;
+            }
+
+            // adds the counters of another interpreter (thread-safe).
+            void merge(const OpProfile_t& other) noexcept;
+            // prints the report sorted by executions.
+            void print(std::ostream& out) noexcept;
+        };
+
+        /*
+         * sampling profiler (option -F): a thread periodically asks each
+         * interpreter to record its call stack before its next instruction.
+         * The stacks are written collapsed, one per line with the frames
+         * separated by ';' and followed by the number of samples, as
+         * flamegraph.pl expects them.
+         */
+        class StackSampler {
+        private:
+            std::string path;
+            std::map<std::string, uint64_t> stacks;
+            std::mutex stacks_m;
+            std::thread th;
+            std::atomic_bool running;
+
+            void run(runtime::Runtime_t* rt) noexcept;
+
+        public:
+            explicit StackSampler(std::string _path) : path(std::move(_path)), running(false) {}
+
+            void start(runtime::Runtime_t& rt);
+            void add(const std::string& stack);
+            // stops the sampling thread and writes the file, only the first time.
+            void stop() noexcept;
+
+            StackSampler(const StackSampler&) = delete;
+            StackSampler& operator=(const StackSampler&) = delete;
+        };
+    }
+}
+
+#endif
@@ -18,8 +18,12 @@
 */
 
 #include <iostream>
+#include <iomanip>
+#include <fstream>
 #include <utility>
 #include <array>
+#include <algorithm>
+#include <mutex>
 
 #include "sm/exec/interpreter/arithmeticOpCodes.h"
 #include "sm/exec/interpreter/assignOpCodes.h"
@@ -32,134 +36,553 @@
 #include "sm/exec/interpreter/logicAndShiftsOpCodes.h"
 #include "sm/exec/interpreter/makeOpCodes.h"
 #include "sm/exec/interpreter/singleOperandMathOpCodes.h"
+#include "sm/exec/interpreter/superOpCodes.h"
 #include "sm/exec/Interpreter.h"
 #include "sm/runtime/id.h"
 
+/*
+ * every opcode with the function which executes it.
+ * X(OpCode, FuncName)
+ */
+#define _OcList(X) \
+    X(NOP, Nop) \
+    X(POP, Pop) \
+    X(IS_NULL, IsNull) \
+    X(ADD, Add) \
+    X(SUB, Sub) \
+    X(MUL, Mul) \
+    X(DIV, Div) \
+    X(MOD, Mod) \
+    X(OR, Or) \
+    X(AND, And) \
+    X(XOR, Xor) \
+    X(LEFT_SHIFT, LeftShift) \
+    X(RIGHT_SHIFT, RightShift) \
+    X(EQUAL, Equal) \
+    X(NOT_EQUAL, NotEqual) \
+    X(GREATER, Greater) \
+    X(GREATER_OR_EQUAL, GreaterOrEqual) \
+    X(LESS, Less) \
+    X(LESS_OR_EQUAL, LessOrEqual) \
+    X(ASSIGN, Assign) \
+    X(ASSIGN_ADD, AssignAdd) \
+    X(ASSIGN_SUB, AssignSub) \
+    X(ASSIGN_MUL, AssignMul) \
+    X(ASSIGN_DIV, AssignDiv) \
+    X(ASSIGN_MOD, AssignMod) \
+    X(ASSIGN_OR, AssignOr) \
+    X(ASSIGN_AND, AssignAnd) \
+    X(ASSIGN_XOR, AssignXor) \
+    X(ASSIGN_LEFT_SHIFT, AssignLeftShift) \
+    X(ASSIGN_RIGHT_SHIFT, AssignRightShift) \
+    X(MAKE_VOID_LIST, MakeVoidList) \
+    X(MAKE_VOID_TUPLE, MakeVoidTuple) \
+    X(MAKE_REF, MakeRef) \
+    X(COMPL, Compl) \
+    X(NOT, Not) \
+    X(UNARY_PLUS, UnaryPlus) \
+    X(UNARY_MINUS, UnaryMinus) \
+    X(INC, Inc) \
+    X(DEC, Dec) \
+    X(POST_INC, PostInc) \
+    X(POST_DEC, PostDec) \
+    X(START_BLOCK, StartBlock) \
+    X(END_BLOCK, EndBlock) \
+    X(THROW_EXCEPTION, ThrowException) \
+    X(RETURN, Return) \
+    X(RETURN_NULL, ReturnNull) \
+    X(PUSH_INT_0, PushInt0) \
+    X(PUSH_INT_1, PushInt1) \
+    X(PUSH_NULL, PushNull) \
+    X(PUSH_THIS, PushThis) \
+    X(PUSH_BOX, PushBox) \
+    X(PUSH_CLASS, PushClass) \
+    X(ITERATE, Iterate) \
+    X(IT_NEXT, ItNext) \
+    X(MAKE_SUPER, MakeSuper) \
+    X(DUP, Dup) \
+    X(DUP1, Dup1) \
+    X(TO_VALUE, ToValue) \
+    X(END_BLOCKS, EndBlocks) \
+    X(PUSH_INTEGER, PushInteger) \
+    X(PUSH_FLOAT, PushFloat) \
+    X(PUSH_STRING, PushString) \
+    X(PUSH_INT_VALUE, PushIntValue) \
+    X(PUSH_REF, PushRef) \
+    X(JUMP_F, JumpF) \
+    X(JUMP_B, JumpB) \
+    X(JUMP_IF_F, JumpIfF) \
+    X(JUMP_IF_B, JumpIfB) \
+    X(JUMP_IF_NOT_F, JumpIfNotF) \
+    X(JUMP_IF_NOT_B, JumpIfNotB) \
+    X(LOGIC_AND, LogicAnd) \
+    X(LOGIC_OR, LogicOr) \
+    X(ELVIS, Elvis) \
+    X(TRY, Try) \
+    X(CATCH, Catch) \
+    X(FINALLY, Finally) \
+    X(CALL_FUNCTION, CallFunction) \
+    X(PERFORM_BRACING, PerformBracing) \
+    X(DEFINE_GLOBAL_VAR, DefineGlobalVar) \
+    X(DEFINE_GLOBAL_NULL_VAR, DefineGlobalNullVar) \
+    X(ASSIGN_NULL_POP, AssignNullPop) \
+    X(FIND, Find) \
+    X(FIND_SUPER, FindSuper) \
+    X(MAKE_LIST, MakeList) \
+    X(MAKE_TUPLE, MakeTuple) \
+    X(FOREACH_CHECK, ForeachCheck) \
+    X(SWITCH_CASE, SwitchCase) \
+    X(IMPORT, Import) \
+    X(LOAD_LOCAL, LoadLocal) \
+    X(DEFINE_LOCAL, DefineLocal) \
+    X(DEFINE_NULL_LOCAL, DefineNullLocal) \
+    X(CALL_METHOD, CallMethod) \
+    X(CMP_JUMP_IF_NOT_F, CmpJumpIfNotF) \
+    X(LOCAL_CMP_JUMP_IF_NOT_F, LocalCmpJumpIfNotF) \
+    X(LOCAL_OP, LocalOp) \
+    X(LOCAL_ASSIGN_OP_POP, LocalAssignOpPop) \
+    X(LOCAL_INC_POP, LocalIncPop)
+
 #define _OcCase(OpCode, FuncName) \
     case compile::OpCode:{ \
-        FuncName(*this, inst); \
+        FuncName(*this, ti->inst); \
         break; \
     }
 
+#ifdef _SM_THREADED_DISPATCH
+#   define _OcLabel(OpCode, FuncName) \
+        labels[compile::OpCode] = &&L_##OpCode;
+
+#   define _OcDispatch \
+        if(doReturn) \
+            goto End; \
+        if(funcStack.size() > rt->max_ss) \
+            stackOverflow(); \
+        ti = code + pc; \
+        pc += ti->size; \
+        goto *ti->label;
+
+#   define _OcThreadedCase(OpCode, FuncName) \
+        L_##OpCode: \
+            FuncName(*this, ti->inst); \
+            _OcDispatch
+#endif
+
 namespace sm{
     namespace lib{
         extern Class* cString;
     }
 
     namespace exec{
-        RootObject Interpreter::start(){
-            while(!doReturn){
-                if(funcStack.size() > rt->max_ss){
-                    rt->sources.printStackTrace(*this, error::ET_FATAL_ERROR,
-                        "stack overflow");
+        namespace {
+            bool isCompare(uint8_t op){
+                return op >= compile::EQUAL && op <= compile::LESS_OR_EQUAL;
+            }
+
+            bool isMath(uint8_t op){
+                return op >= compile::ADD && op <= compile::XOR;
+            }
+
+            bool isAssignMath(uint8_t op){
+                return op >= compile::ASSIGN_ADD && op <= compile::ASSIGN_XOR;
+            }
+
+            // sets the second operand of a superinstruction (see superOpCodes.h).
+            bool superOperand(const ThreadedInst_t& ti, InstBytes_t& inst){
+                switch(ti.inst[0]){
+                    case compile::LOAD_LOCAL:
+                        inst[8] = SO_LOCAL;
+                        inst[9] = ti.inst[1];
+                        inst[10] = ti.inst[2];
+                        return true;
+
+                    case compile::PUSH_INT_0:
+                    case compile::PUSH_INT_1:
+                        inst[8] = SO_VALUE;
+                        inst[9] = 0;
+                        inst[10] = ti.inst[0] == compile::PUSH_INT_1;
+                        return true;
+
+                    case compile::PUSH_INT_VALUE:
+                    case compile::PUSH_INTEGER:
+                        inst[8] = ti.inst[0] == compile::PUSH_INT_VALUE ? SO_VALUE : SO_CONSTANT;
+                        inst[9] = ti.inst[1];
+                        inst[10] = ti.inst[2];
+                        return true;
+
+                    default:
+                        return false;
+                }
+            }
+
+            /*
+             * peephole: if the instructions starting at 'starts[i]' can be
+             * run by a superinstruction, sets it in 'out' (without label).
+             */
+            bool fuse(const ThreadedCode_t& tc, const std::vector<size_t>& starts,
+                    size_t i, ThreadedInst_t& out){
+                const ThreadedInst_t* seq[4] = {};
+                uint8_t op[4];
+                for(size_t k = 0; k != 4; ++k){
+                    seq[k] = i + k < starts.size() ? &tc[starts[i + k]] : nullptr;
+                    op[k] = seq[k] ? seq[k]->inst[0] : compile::INVALID_OPCODE;
                 }
 
-                std::array<uint8_t, 5> inst = fetch(pc);
-                switch(inst[0]){
-                    _OcCase(NOP, Nop);
-                    _OcCase(POP, Pop);
-                    _OcCase(IS_NULL, IsNull);
-                    _OcCase(ADD, Add);
-                    _OcCase(SUB, Sub);
-                    _OcCase(MUL, Mul);
-                    _OcCase(DIV, Div);
-                    _OcCase(MOD, Mod);
-                    _OcCase(OR, Or);
-                    _OcCase(AND, And);
-                    _OcCase(XOR, Xor);
-                    _OcCase(LEFT_SHIFT, LeftShift);
-                    _OcCase(RIGHT_SHIFT, RightShift);
-                    _OcCase(EQUAL, Equal);
-                    _OcCase(NOT_EQUAL, NotEqual);
-                    _OcCase(GREATER, Greater);
-                    _OcCase(GREATER_OR_EQUAL, GreaterOrEqual);
-                    _OcCase(LESS, Less);
-                    _OcCase(LESS_OR_EQUAL, LessOrEqual);
-                    _OcCase(ASSIGN, Assign);
-                    _OcCase(ASSIGN_ADD, AssignAdd);
-                    _OcCase(ASSIGN_SUB, AssignSub);
-                    _OcCase(ASSIGN_MUL, AssignMul);
-                    _OcCase(ASSIGN_DIV, AssignDiv);
-                    _OcCase(ASSIGN_MOD, AssignMod);
-                    _OcCase(ASSIGN_OR, AssignOr);
-                    _OcCase(ASSIGN_AND, AssignAnd);
-                    _OcCase(ASSIGN_XOR, AssignXor);
-                    _OcCase(ASSIGN_LEFT_SHIFT, AssignLeftShift);
-                    _OcCase(ASSIGN_RIGHT_SHIFT, AssignRightShift);
-                    _OcCase(MAKE_VOID_LIST, MakeVoidList);
-                    _OcCase(MAKE_VOID_TUPLE, MakeVoidTuple);
-                    _OcCase(MAKE_REF, MakeRef);
-                    _OcCase(COMPL, Compl);
-                    _OcCase(NOT, Not);
-                    _OcCase(UNARY_PLUS, UnaryPlus);
-                    _OcCase(UNARY_MINUS, UnaryMinus);
-                    _OcCase(INC, Inc);
-                    _OcCase(DEC, Dec);
-                    _OcCase(POST_INC, PostInc);
-                    _OcCase(POST_DEC, PostDec);
-                    _OcCase(START_BLOCK, StartBlock);
-                    _OcCase(END_BLOCK, EndBlock);
-                    _OcCase(THROW_EXCEPTION, ThrowException);
-                    _OcCase(RETURN, Return);
-                    _OcCase(RETURN_NULL, ReturnNull);
-                    _OcCase(PUSH_INT_0, PushInt0);
-                    _OcCase(PUSH_INT_1, PushInt1);
-                    _OcCase(PUSH_NULL, PushNull);
-                    _OcCase(PUSH_THIS, PushThis);
-                    _OcCase(PUSH_BOX, PushBox);
-                    _OcCase(PUSH_CLASS, PushClass);
-                    _OcCase(ITERATE, Iterate);
-                    _OcCase(IT_NEXT, ItNext);
-                    _OcCase(MAKE_SUPER, MakeSuper);
-                    _OcCase(DUP, Dup);
-                    _OcCase(DUP1, Dup1);
-                    _OcCase(END_BLOCKS, EndBlocks);
-                    _OcCase(PUSH_INTEGER, PushInteger);
-                    _OcCase(PUSH_FLOAT, PushFloat);
-                    _OcCase(PUSH_STRING, PushString);
-                    _OcCase(PUSH_INT_VALUE, PushIntValue);
-                    _OcCase(PUSH_REF, PushRef);
-                    _OcCase(JUMP_F, JumpF);
-                    _OcCase(JUMP_B, JumpB);
-                    _OcCase(JUMP_IF_F, JumpIfF);
-                    _OcCase(JUMP_IF_B, JumpIfB);
-                    _OcCase(JUMP_IF_NOT_F, JumpIfNotF);
-                    _OcCase(JUMP_IF_NOT_B, JumpIfNotB);
-                    _OcCase(LOGIC_AND, LogicAnd);
-                    _OcCase(LOGIC_OR, LogicOr);
-                    _OcCase(ELVIS, Elvis);
-                    _OcCase(TRY, Try);
-                    _OcCase(CATCH, Catch);
-                    _OcCase(FINALLY, Finally);
-                    _OcCase(CALL_FUNCTION, CallFunction);
-                    _OcCase(PERFORM_BRACING, PerformBracing);
-                    _OcCase(DEFINE_VAR, DefineVar);
-                    _OcCase(DEFINE_GLOBAL_VAR, DefineGlobalVar);
-                    _OcCase(DEFINE_NULL_VAR, DefineNullVar);
-                    _OcCase(DEFINE_GLOBAL_NULL_VAR, DefineGlobalNullVar);
-                    _OcCase(ASSIGN_NULL_POP, AssignNullPop);
-                    _OcCase(FIND, Find);
-                    _OcCase(FIND_SUPER, FindSuper);
-                    _OcCase(MAKE_LIST, MakeList);
-                    _OcCase(MAKE_TUPLE, MakeTuple);
-                    _OcCase(FOREACH_CHECK, ForeachCheck);
-                    _OcCase(SWITCH_CASE, SwitchCase);
-                    _OcCase(IMPORT, Import);
-
-                    default: {
-                        rt->sources.printStackTrace(*this, error::ET_FATAL_ERROR,
-                            std::string("unsupported instruction's opcode (")
-                            + std::to_string(inst[0]) + ").");
+                size_t n = 0;
+                out = *seq[0];
+
+                if(isCompare(op[0]) && op[1] == compile::JUMP_IF_NOT_F){
+                    out.inst[0] = compile::CMP_JUMP_IF_NOT_F;
+                    out.inst[5] = op[0];
+                    out.inst[6] = seq[1]->inst[1];
+                    out.inst[7] = seq[1]->inst[2];
+                    n = 2;
+                } else if(op[0] == compile::LOAD_LOCAL){
+                    if(op[1] >= compile::INC && op[1] <= compile::POST_DEC && op[2] == compile::POP){
+                        out.inst[0] = compile::LOCAL_INC_POP;
+                        out.inst[5] = op[1];
+                        n = 3;
+                    } else if(seq[1] && superOperand(*seq[1], out.inst)){
+                        if(isCompare(op[2]) && op[3] == compile::JUMP_IF_NOT_F){
+                            out.inst[0] = compile::LOCAL_CMP_JUMP_IF_NOT_F;
+                            out.inst[5] = op[2];
+                            out.inst[6] = seq[3]->inst[1];
+                            out.inst[7] = seq[3]->inst[2];
+                            n = 4;
+                        } else if(isMath(op[2])){
+                            out.inst[0] = compile::LOCAL_OP;
+                            out.inst[5] = op[2];
+                            n = 3;
+                        } else if(isAssignMath(op[2]) && op[3] == compile::POP){
+                            out.inst[0] = compile::LOCAL_ASSIGN_OP_POP;
+                            out.inst[5] = op[2] - compile::ASSIGN_START + compile::OPERATORS_START;
+                            n = 4;
+                        }
+                    }
+                }
+
+                if(!n)
+                    return false;
+
+                out.size = 0;
+                for(size_t k = 0; k != n; ++k)
+                    out.size += seq[k]->size;
+                out.inst[11] = out.size - seq[0]->size;
+                return true;
+            }
+        }
+
+        void Interpreter::stackOverflow(){
+            rt->sources.printStackTrace(*this, error::ET_FATAL_ERROR,
+                "stack overflow");
+        }
+
+        void Interpreter::decode(const void* const* labels){
+            const ByteCode_t& bc = rt->code;
+            size_t size = bc.size();
+            ThreadedCode_t& tc = rt->threadedCode;
+
+            // the extra entry catches the jumps past the end of the code.
+            tc.assign(size + 1, ThreadedInst_t());
+
+            rt->stringObjects.clear();
+            rt->stringObjects.reserve(rt->stringConstants.size());
+            for(const String& str : rt->stringConstants)
+                rt->stringObjects.emplace_back(makeString(str));
+
+            size_t nextInst = 0; // the code is a plain sequence of instructions
+            std::vector<size_t> starts;
+            for(size_t addr = 0; addr != size; ++addr){
+                ThreadedInst_t& ti = tc[addr];
+                uint8_t opcode = ti.inst[0] = bc[addr];
+                if((opcode & 0xC0) == 0x80){
+                    // superinstructions are made only by this function.
+                    opcode = ti.inst[0] = compile::INVALID_OPCODE;
+                } else if(opcode & 0x40){
+                    uint8_t instSize = (opcode & 0x80) ? 5 : 3;
+                    if(addr + instSize > size){
+                        // truncated instruction.
+                        opcode = ti.inst[0] = compile::INVALID_OPCODE;
+                    } else {
+                        ti.size = instSize;
+                        for(uint8_t i = 1; i != instSize; ++i)
+                            ti.inst[i] = bc[addr + i];
+
                     }
                 }
+
+                if(opcode == compile::FIND || opcode == compile::PUSH_REF
+                        || opcode == compile::CALL_METHOD){
+                    // offsets in the middle of another instruction don't need a cache.
+                    unsigned cache = (addr == nextInst && rt->n_caches < noCache)
+                        ? rt->n_caches++ : noCache;
+                    ti.inst[5] = cache >> 8;
+                    ti.inst[6] = cache & 0xFF;
+                }
+
+                if(addr == nextInst){
+                    nextInst += ti.size;
+                    starts.push_back(addr);
+                }
+                #ifdef _SM_THREADED_DISPATCH
+                    ti.label = labels[opcode];
+                #endif
+            }
+
+            /*
+             * a superinstruction replaces only the first entry of its
+             * sequence: the jumps into the sequence land on the plain ones.
+             */
+            for(size_t i = 0; i != starts.size(); ++i){
+                ThreadedInst_t fused;
+                if(fuse(tc, starts, i, fused)){
+                    #ifdef _SM_THREADED_DISPATCH
+                        fused.label = labels[fused.inst[0]];
+                    #endif
+                    tc[starts[i]] = fused;
+                }
+            }
+
+            tc.back().inst[0] = compile::INVALID_OPCODE;
+            #ifdef _SM_THREADED_DISPATCH
+                tc.back().label = labels[compile::INVALID_OPCODE];
+            #endif
+        }
+
+        RootObject Interpreter::start(){
+            const ThreadedInst_t* ti;
+            const ThreadedInst_t* code;
+            #ifdef _SM_THREADED_DISPATCH
+                static const void* labels[256]; // the handlers, indexed by opcode
+            #endif
+
+            if(!rt->threadedReady.load(std::memory_order_acquire)){
+                std::lock_guard<std::mutex> lock(rt->threadedCode_m);
+                if(!rt->threadedReady.load(std::memory_order_relaxed)){
+                    #ifdef _SM_THREADED_DISPATCH
+                        std::fill(labels, labels + 256, &&Unsupported);
+                        _OcList(_OcLabel)
+                        decode(labels);
+
+                        // with options -P and -F, each instruction goes through 'Instrumented'.
+                        if(runtime::Runtime_t::opProfile || runtime::Runtime_t::sampler){
+                            for(ThreadedInst_t& inst : rt->threadedCode)
+                                inst.label = &&Instrumented;
+                        }
+                    #else
+                        decode(nullptr);
+                    #endif
+                    rt->threadedReady.store(true, std::memory_order_release);
+                }
             }
+            code = rt->threadedCode.data();
+            if(caches.size() < rt->n_caches)
+                caches.resize(rt->n_caches);
 
+            if(runtime::Runtime_t::opProfile && !profile){
+                if(this == rt->main_intp){
+                    profile = runtime::Runtime_t::opProfile;
+                } else {
+                    ownProfile.reset(new OpProfile_t);
+                    profile = ownProfile.get();
+                }
+            }
+
+            #ifdef _SM_THREADED_DISPATCH
+                _OcDispatch
+
+                _OcList(_OcThreadedCase)
+
+                Instrumented:
+                    if(profile)
+                        profile->record(ti->inst[0]);
+                    if(sampleNow.load(std::memory_order_relaxed))
+                        sampleStack();
+                    goto *labels[ti->inst[0]];
+
+                Unsupported:
+                    rt->sources.printStackTrace(*this, error::ET_FATAL_ERROR,
+                        std::string("unsupported instruction's opcode (")
+                        + std::to_string(ti->inst[0]) + ").");
+                    _OcDispatch
+            #else
+                while(!doReturn){
+                    if(funcStack.size() > rt->max_ss)
+                        stackOverflow();
+
+                    ti = code + pc;
+                    pc += ti->size;
+                    if(profile)
+                        profile->record(ti->inst[0]);
+                    if(sampleNow.load(std::memory_order_relaxed))
+                        sampleStack();
+
+                    switch(ti->inst[0]){
+                        _OcList(_OcCase)
+
+                        default: {
+                            rt->sources.printStackTrace(*this, error::ET_FATAL_ERROR,
+                                std::string("unsupported instruction's opcode (")
+                                + std::to_string(ti->inst[0]) + ").");
+                        }
+                    }
+                }
+                goto End;
+            #endif
+
+            End:
             doReturn = false;
             RootObject obj(std::move(exprStack.back()));
             exprStack.pop_back();
             return obj;
         }
 
+        Interpreter::~Interpreter(){
+            if(ownProfile)
+                runtime::Runtime_t::opProfile->merge(*ownProfile);
+            rt->gc.giveRegion(region);
+        }
+
+        void Interpreter::sampleStack(){
+            sampleNow.store(false, std::memory_order_relaxed);
+
+            std::string stack;
+            for(const CallInfo_t& info : funcStack){
+                if(!stack.empty())
+                    stack.push_back(';');
+                if(info.inlined && &info != &funcStack.front())
+                    stack += "<native>;";
+
+                stack += rt->boxNames[info.box->name] + "::";
+                if(info.thisObject->type == ObjectType::CLASS_INSTANCE && info.thisObject->i_ptr->base)
+                    stack += rt->nameFromId(info.thisObject->i_ptr->base->name) + "::";
+                stack += rt->nameFromId(info.function->fnName) + "()";
+
+                std::string location = rt->location(&info == &funcStack.back() ? pc : info.pc);
+                if(!location.empty())
+                    stack += "[" + location + "]";
+            }
+
+            if(!stack.empty())
+                runtime::Runtime_t::sampler->add(stack);
+        }
+
+        void StackSampler::start(runtime::Runtime_t& rt){
+            running = true;
+            th = std::thread(&StackSampler::run, this, &rt);
+        }
+
+        void StackSampler::run(runtime::Runtime_t* rt) noexcept{
+            constexpr std::chrono::microseconds interval (1000000 / _SM_SAMPLING_HZ);
+            while(running.load()){
+                std::this_thread::sleep_for(interval);
+
+                std::lock_guard<std::mutex> lock(rt->threads_m);
+                if(rt->main_intp)
+                    rt->main_intp->sampleNow.store(true, std::memory_order_relaxed);
+                for(std::pair<const std::thread::id, ThreadData>& thread : rt->threads){
+                    if(thread.second.data)
+                        thread.second.data->intp.sampleNow.store(true, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        void StackSampler::add(const std::string& stack){
+            std::lock_guard<std::mutex> lock(stacks_m);
+            ++stacks[stack];
+        }
+
+        void StackSampler::stop() noexcept{
+            if(!running.exchange(false))
+                return;
+            if(th.joinable() && th.get_id() != std::this_thread::get_id())
+                th.join();
+
+            std::lock_guard<std::mutex> lock(stacks_m);
+            std::ofstream out(path);
+            if(!out){
+                std::cerr << "error: cannot write the stack samples to '" << path << "'." << std::endl;
+                return;
+            }
+
+            for(const std::pair<const std::string, uint64_t>& stack : stacks)
+                out << stack.first << " " << stack.second << "\n";
+        }
+
+        void OpProfile_t::merge(const OpProfile_t& other) noexcept{
+            std::lock_guard<std::mutex> lock(merge_m);
+            for(size_t i = 0; i != 256; ++i){
+                counts[i] += other.counts[i];
+                ticks[i] += other.ticks[i];
+            }
+            for(size_t i = 0; i != pairs.size(); ++i)
+                pairs[i] += other.pairs[i];
+        }
+
+        void OpProfile_t::print(std::ostream& out) noexcept{
+            constexpr size_t maxPairs = 40;
+            #ifdef _SM_PROFILER_CYCLES
+                constexpr const char* unit = "cycles";
+            #else
+                constexpr const char* unit = "ns";
+            #endif
+
+            std::lock_guard<std::mutex> lock(merge_m);
+            uint64_t totalCount = 0, totalTicks = 0;
+            std::vector<unsigned> ops;
+            for(unsigned i = 0; i != 256; ++i){
+                totalCount += counts[i];
+                totalTicks += ticks[i];
+                if(counts[i])
+                    ops.push_back(i);
+            }
+
+            std::sort(ops.begin(), ops.end(), [this](unsigned a, unsigned b){
+                return counts[a] > counts[b];
+            });
+
+            std::ios::fmtflags flags = out.flags();
+            out << std::fixed << std::setprecision(2);
+            out << ".. Opcode profile: " << totalCount << " instructions, "
+                << totalTicks << " " << unit << "." << std::endl;
+            out << "  " << std::left << std::setw(26) << "opcode" << std::right
+                << std::setw(14) << "count" << std::setw(8) << "%"
+                << std::setw(16) << unit << std::setw(8) << "%"
+                << std::setw(10) << "avg" << std::endl;
+
+            for(unsigned op : ops){
+                out << "  " << std::left << std::setw(26) << compile::test::instRepr(op) << std::right
+                    << std::setw(14) << counts[op]
+                    << std::setw(8) << 100. * counts[op] / totalCount
+                    << std::setw(16) << ticks[op]
+                    << std::setw(8) << (totalTicks ? 100. * ticks[op] / totalTicks : 0.)
+                    << std::setw(10) << static_cast<double>(ticks[op]) / counts[op] << std::endl;
+            }
+
+            std::vector<unsigned> topPairs;
+            uint64_t totalPairs = 0;
+            for(unsigned i = 0; i != pairs.size(); ++i){
+                totalPairs += pairs[i];
+                if(pairs[i])
+                    topPairs.push_back(i);
+            }
+
+            std::sort(topPairs.begin(), topPairs.end(), [this](unsigned a, unsigned b){
+                return pairs[a] > pairs[b];
+            });
+            if(topPairs.size() > maxPairs)
+                topPairs.resize(maxPairs);
+
+            out << ".. Opcode pairs (top " << topPairs.size() << "):" << std::endl;
+            for(unsigned pair : topPairs){
+                out << "  " << std::left << std::setw(52)
+                    << (compile::test::instRepr(pair / 256) + " -> " + compile::test::instRepr(pair % 256))
+                    << std::right << std::setw(14) << pairs[pair]
+                    << std::setw(8) << 100. * pairs[pair] / totalPairs << std::endl;
+            }
+            out.flags(flags);
+        }
+
         RootObject Interpreter::callFunction(Function* fn, const RootObjectVec_t& args,
                 const RootObject& self, bool inlined){
             if(!funcStack.empty() && !inlined){
@@ -228,60 +651,95 @@ namespace sm{
                 exprStack.emplace_back(std::move(ret));
                 doReturn = inlined;
             } else {
-                if(!funcStack.empty()){
-                    funcStack.back().pc = pc;
+                // the arguments take the first slots of the frame.
+                size_t localsBase = locals.size();
+                for(const RootObject& arg : args){
+                    locals.emplace_back();
+                    locals.back().obj = arg;
                 }
+                enterFrame(fn, localsBase, args.size(), self, inlined);
+            }
+        }
 
-                RootObjectDict_t* dict = new RootObjectDict_t;
-                bool is_vararg = fn->flags & FF_VARARGS;
-                size_t n_args = args.size();
-                size_t n_expected = is_vararg ? fn->arguments.size()-1 : fn->arguments.size();
-                size_t address = 0;
+        void Interpreter::makeStackCall(Function* fn, unsigned n_args, const RootObject& self){
+            RootObjectVec_t::iterator end = exprStack.end();
+            RootObjectVec_t::iterator first = end - n_args;
 
-                if(fn->arguments.empty()){
-                    address = fn->address;
+            for(RootObjectVec_t::iterator it = first; it != end; ++it){
+                Object& obj = *it;
+                if(obj.type == ObjectType::WEAK_REFERENCE){
+                    obj = obj.refGet();
+                } else if(obj.type == ObjectType::STRONG_REFERENCE){
+                    obj.type = ObjectType::WEAK_REFERENCE;
+                }
+            }
 
-                    if(is_vararg){
-                        (*dict)[std::get<0>(fn->arguments.back())] = makeList(*this);
-                    }
-                } else {
-                    for(size_t i = 0; i != n_expected; ++i){
-                        RootObject obj;
-                        if(i < n_args){
-                            obj = args[i];
-                        }
-                        (*dict)[std::get<0>(fn->arguments[i])] = std::move(obj);
-                    }
+            if(self->type == ObjectType::INSTANCE_CREATOR || fn->flags & FF_NATIVE){
+                RootObjectVec_t args(
+                    std::make_move_iterator(first),
+                    std::make_move_iterator(end)
+                );
+                exprStack.erase(first -1, end);
+                makeCall(fn, args, self);
+                return;
+            }
 
-                    if(is_vararg){
-                        RootObject ls;
-                        if(n_args > n_expected){
-                            ls = makeList(*this, RootObjectVec_t(args.begin() + n_expected, args.end()));
-                        } else {
-                            ls = makeList(*this);
-                        }
-                        (*dict)[std::get<0>(fn->arguments.back())] = std::move(ls);
-                    }
+            size_t localsBase = locals.size();
+            for(RootObjectVec_t::iterator it = first; it != end; ++it){
+                locals.emplace_back();
+                locals.back().obj = std::move(*it);
+            }
 
-                    if(n_args == 0){
-                        address = fn->address;
-                    } else if(n_args < fn->arguments.size()){
-                        address = std::get<1>(fn->arguments[n_args -1]);
-                    } else {
-                        address = std::get<1>(fn->arguments.back());
-                    }
+            exprStack.erase(first -1, end);
+            enterFrame(fn, localsBase, n_args, self, false);
+        }
+
+        void Interpreter::enterFrame(Function* fn, size_t localsBase, size_t n_args,
+                const RootObject& self, bool inlined){
+            if(!funcStack.empty()){
+                funcStack.back().pc = pc;
+            }
+
+            bool is_vararg = fn->flags & FF_VARARGS;
+            size_t n_expected = is_vararg ? fn->arguments.size()-1 : fn->arguments.size();
+            size_t address = 0;
+
+            if(is_vararg){
+                RootObjectVec_t varargs;
+                if(n_args > n_expected){
+                    for(size_t i = localsBase + n_expected; i != locals.size(); ++i)
+                        varargs.emplace_back(std::move(locals[i].obj));
                 }
+                locals.resize(localsBase + n_expected);
+                locals.emplace_back();
+                locals.back().obj = makeList(*this, std::move(varargs));
+            } else {
+                locals.resize(localsBase + n_expected);
+            }
+
+            for(size_t i = 0; i != fn->arguments.size(); ++i){
+                LocalSlot_t& local = locals[localsBase + i];
+                local.name = std::get<0>(fn->arguments[i]);
+                local.defined = true;
+            }
 
-                funcStack.emplace_back();
-                CallInfo_t& backInfo = funcStack.back();
-                backInfo.codeBlocks.reserve(5);
-                backInfo.codeBlocks.push_back(dict);
-                backInfo.function = fn;
-                backInfo.box = rt->boxes[fn->boxName];
-                backInfo.thisObject = self;
-                backInfo.inlined = inlined;
-                pc = address;
+            if(n_args == 0 || fn->arguments.empty()){
+                address = fn->address;
+            } else if(n_args < fn->arguments.size()){
+                address = std::get<1>(fn->arguments[n_args -1]);
+            } else {
+                address = std::get<1>(fn->arguments.back());
             }
+
+            funcStack.emplace_back();
+            CallInfo_t& backInfo = funcStack.back();
+            backInfo.localsBase = localsBase;
+            backInfo.blocksBase = blocks.size();
+            backInfo.function = fn;
+            backInfo.box = rt->boxes[fn->boxName];
+            backInfo.thisObject = self;
+            backInfo.inlined = inlined;
+            pc = address;
         }
 
         void Interpreter::printStackContent(){
@@ -289,11 +747,5 @@ namespace sm{
             for(auto& obj : exprStack)
                 std::cout << "\t" << runtime::errorString(*this, obj) << std::endl;
         }
-
-        Interpreter::~Interpreter(){
-            for(exec::CallInfo_t& callInfo : funcStack)
-                for(RootObjectDict_t* dict : callInfo.codeBlocks)
-                    if(dict) delete dict;
-        }
     }
 }
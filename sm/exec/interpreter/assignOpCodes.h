@@ -53,8 +53,22 @@ namespace sm{
             _OcStore(tos1);
             _OcValue(tos1);
             _OcSimplifyRef(tos);
-            _OcOp(+, std::plus<float_t>(), parse::TT_PLUS, true,
-                intp.exprStack.emplace_back(intp.start()));
+
+            /*
+             * str += obj: if the string is pointed only by the variable
+             * and by tos1, nobody else can see it change, so it's
+             * appended in place instead of copied (see Runtime_t::stringObjects).
+             */
+            if(tos1->type == ObjectType::STRING && (tos->type == ObjectType::STRING
+                        || tos->type == ObjectType::INTEGER || tos->type == ObjectType::FLOAT)
+                    && tos1->s_ptr->rcount.load(std::memory_order_relaxed) == 2){
+                Object str = runtime::implicitToString(intp, tos);
+                tos1->s_ptr->str.append(str.s_ptr->str);
+                tos1->s_ptr->changed();
+            } else {
+                _OcOp(+, std::plus<float_t>(), parse::TT_PLUS, true,
+                    intp.exprStack.emplace_back(intp.start()));
+            }
             Assign(intp, {});
         }
 
@@ -27,23 +27,34 @@
 
 namespace sm{
     namespace exec{
-        _OcFunc(DefineVar){
-            unsigned id = ((static_cast<uint16_t>(inst[1]) << 8) | inst[2]) + runtime::idsStart;
+        /*
+         * returns the local in slot 'slot' of the current frame,
+         * creating it (and the ones before) if it doesn't exist.
+         */
+        inline LocalSlot_t& localSlot(sm::exec::Interpreter& intp, unsigned slot) noexcept{
+            size_t idx = intp.funcStack.back().localsBase + slot;
+            if(idx >= intp.locals.size())
+                intp.locals.resize(idx +1);
+            return intp.locals[idx];
+        }
+
+        _OcFunc(DefineLocal){
+            unsigned slot = (static_cast<uint16_t>(inst[1]) << 8) | inst[2];
+            unsigned id = ((static_cast<uint16_t>(inst[3]) << 8) | inst[4]) + runtime::idsStart;
             _OcPopStore(tos);
             _OcSimplifyRef(tos);
 
-            RootObjectDict_t*& dict = intp.funcStack.back().codeBlocks.back();
-            if(!dict)
-                dict = new RootObjectDict_t;
-            RootObjectDict_t::const_iterator it = dict->find(id);
-
-            if(it != dict->end()){
+            LocalSlot_t& local = localSlot(intp, slot);
+            if(local.defined){
                 intp.rt->sources.printStackTrace(intp, error::ET_ERROR,
                     std::string("redeclaration of variable named '") + intp.rt->nameFromId(id)
                     + "' in the same scope");
             }
 
-            intp.exprStack.emplace_back(makeRef((*dict)[id] = tos));
+            local.obj = std::move(tos);
+            local.name = id;
+            local.defined = true;
+            intp.exprStack.emplace_back(makeRef(local.obj));
         }
 
         _OcFunc(DefineGlobalVar){
@@ -66,34 +77,33 @@ namespace sm{
 
                 intp.exprStack.emplace_back(makeRef(dict[id] = tos));
             } else {
-                ObjectDict_t& dict = back.thisObject->i_ptr->objects;
-                ObjectDict_t::const_iterator it = dict.find(id);
+                Instance* in = back.thisObject->i_ptr;
 
-                if(it != dict.end())
+                if(in->field(id))
                     intp.rt->sources.printStackTrace(intp, error::ET_ERROR,
                         std::string("redeclaration of variable named '") + intp.rt->nameFromId(id)
                         + "' in the box " + intp.rt->boxNames[intp.funcStack.back().box->name]
                     );
 
-                intp.exprStack.emplace_back(makeRef(dict[id] = tos));
+                intp.exprStack.emplace_back(makeRef(in->addField(id) = tos));
             }
         }
 
-        _OcFunc(DefineNullVar){
-            unsigned id = ((static_cast<uint16_t>(inst[1]) << 8) | inst[2]) + runtime::idsStart;
-
-            RootObjectDict_t*& dict = intp.funcStack.back().codeBlocks.back();
-            if(!dict)
-                dict = new RootObjectDict_t;
-            RootObjectDict_t::const_iterator it = dict->find(id);
+        _OcFunc(DefineNullLocal){
+            unsigned slot = (static_cast<uint16_t>(inst[1]) << 8) | inst[2];
+            unsigned id = ((static_cast<uint16_t>(inst[3]) << 8) | inst[4]) + runtime::idsStart;
 
-            if(it != dict->end()){
+            LocalSlot_t& local = localSlot(intp, slot);
+            if(local.defined){
                 intp.rt->sources.printStackTrace(intp, error::ET_ERROR,
                     std::string("redeclaration of variable named '") + intp.rt->nameFromId(id)
                     + "' in the same scope");
             }
 
-            intp.exprStack.emplace_back(makeRef((*dict)[id] = nullptr));
+            local.obj = nullptr;
+            local.name = id;
+            local.defined = true;
+            intp.exprStack.emplace_back(makeRef(local.obj));
         }
 
         _OcFunc(DefineGlobalNullVar){
@@ -112,15 +122,14 @@ namespace sm{
                     );
                 intp.exprStack.emplace_back(makeRef(dict[id] = nullptr));
             } else {
-                ObjectDict_t& dict = back.thisObject->i_ptr->objects;
-                ObjectDict_t::const_iterator it = dict.find(id);
+                Instance* in = back.thisObject->i_ptr;
 
-                if(it != dict.end())
+                if(in->field(id))
                     intp.rt->sources.printStackTrace(intp, error::ET_ERROR,
                         std::string("redeclaration of variable named '") + intp.rt->nameFromId(id)
                         + "' in the box " + intp.rt->boxNames[intp.funcStack.back().box->name]
                     );
-                intp.exprStack.emplace_back(makeRef(dict[id] = nullptr));
+                intp.exprStack.emplace_back(makeRef(in->addField(id) = nullptr));
             }
         }
     }
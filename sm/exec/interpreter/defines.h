@@ -26,7 +26,7 @@
 #include "sm/runtime/Object.h"
 #include "sm/exec/Interpreter.h"
 
-#define _OcFunc(Name) inline void Name(sm::exec::Interpreter& intp, std::array<uint8_t, 5> inst) noexcept
+#define _OcFunc(Name) inline void Name(sm::exec::Interpreter& intp, const sm::exec::InstBytes_t& inst) noexcept
 
 #define _OcPopStore(Name) \
     sm::RootObject Name = std::move(intp.exprStack.back()); \
@@ -34,6 +34,54 @@ namespace sm{
     }
 
     namespace exec{
+        inline MemberCache_t* memberCache(sm::exec::Interpreter& intp,
+                const InstBytes_t& inst) noexcept{
+            unsigned cache = (static_cast<uint16_t>(inst[5]) << 8) | inst[6];
+            return cache == noCache ? nullptr : &intp.caches[cache];
+        }
+
+        // searches 'id' in 'base' and in its bases, depth-first.
+        inline Object* findInBases(Class* base, unsigned id) noexcept{
+            ObjectDict_t::iterator it = base->objects.find(id);
+            if(it != base->objects.end())
+                return &it->second;
+
+            std::vector<Class*> to_check (base->bases.rbegin(), base->bases.rend());
+            while(!to_check.empty()){
+                base = to_check.back();
+                to_check.pop_back();
+
+                it = base->objects.find(id);
+                if(it != base->objects.end())
+                    return &it->second;
+
+                to_check.insert(to_check.end(), base->bases.rbegin(), base->bases.rend());
+            }
+            return nullptr;
+        }
+
+        /*
+         * searches 'id' in the fields of 'in', then in its class and
+         * in its bases. Returns nullptr if it isn't found.
+         */
+        inline Object* findMember(Instance* in, unsigned id, MemberCache_t* cache) noexcept{
+            const MemberCache_t::Entry_t* entry = cache ? cache->lookup(in->shape, in->base) : nullptr;
+            if(entry)
+                return entry->member ? entry->member : &in->fields[entry->field];
+
+            Dict_t<unsigned>::const_iterator it = in->shape->slots.find(id);
+            if(it != in->shape->slots.end()){
+                if(cache)
+                    cache->store(in->shape, in->base, nullptr, it->second, true);
+                return &in->fields[it->second];
+            }
+
+            Object* member = findInBases(in->base, id);
+            if(member && cache)
+                cache->store(in->shape, in->base, member, 0, true);
+            return member;
+        }
+
         _OcFunc(Pop){
             intp.exprStack.pop_back();
         }
@@ -60,6 +108,13 @@ namespace sm{
             intp.exprStack[sz-1] = intp.exprStack[sz-2];
         }
 
+        _OcFunc(ToValue){
+            RootObject& tos = intp.exprStack.back();
+            if(tos->type == ObjectType::WEAK_REFERENCE
+                    || tos->type == ObjectType::STRONG_REFERENCE)
+                tos = RootObject(tos->refGet());
+        }
+
         _OcFunc(PushInteger){
             uint16_t id = (static_cast<uint16_t>(inst[1]) << 8) | inst[2];
             intp.exprStack.emplace_back(makeInteger(intp.rt->intConstants[id]));
@@ -71,8 +126,7 @@ namespace sm{
         }
 
         _OcFunc(PushString){
-            Object obj = makeString(intp.rt->stringConstants[(static_cast<uint16_t>(inst[1]) << 8) | inst[2]]);
-            intp.exprStack.emplace_back(std::move(obj));
+            intp.exprStack.emplace_back(intp.rt->stringObjects[(static_cast<uint16_t>(inst[1]) << 8) | inst[2]]);
         }
 
         _OcFunc(PushIntValue){
@@ -80,64 +134,89 @@ namespace sm{
             intp.exprStack.emplace_back(makeInteger(static_cast<integer_t>(i16)));
         }
 
-        _OcFunc(PushRef){
-            RootObjectDictVec_t& vec = intp.funcStack.back().codeBlocks;
-            unsigned id = runtime::idsStart + ((static_cast<uint16_t>(inst[1]) << 8) | inst[2]);
-            RootObjectDict_t::iterator oit;
-            ObjectDict_t::iterator oit2;
-
-            for(RootObjectDictVec_t::reverse_iterator it = vec.rbegin(); it != vec.rend(); ++it){
-                if(*it){
-                    oit = (*it)->find(id);
-                    if(oit != (*it)->end()){
-                        intp.exprStack.emplace_back(makeRef(oit->second));
-                        return;
-                    }
+        /*
+         * pushes the reference of the variable named 'id', searching it in
+         * the locals of the current frame below 'top' (an index in
+         * Interpreter::locals), then in 'this' and in the box.
+         * 'cache' may be nullptr.
+         */
+        inline void pushRefByName(sm::exec::Interpreter& intp, unsigned id, size_t top,
+                MemberCache_t* cache) noexcept{
+            CallInfo_t& callInfo = intp.funcStack.back();
+
+            for(size_t i = top; i != callInfo.localsBase;){
+                LocalSlot_t& local = intp.locals[--i];
+                if(local.defined && local.name == id){
+                    intp.exprStack.emplace_back(makeRef(local.obj));
+                    return;
                 }
             }
 
-            RootObject& in = intp.funcStack.back().thisObject;
-            if(in->type != ObjectType::NONE){
-                oit2 = in->i_ptr->objects.find(id);
+            RootObject& in = callInfo.thisObject;
+            bool inMethod = in->type != ObjectType::NONE;
+            const void* owner = inMethod ? in->i_ptr->shape : nullptr;
+            const Class* base = inMethod ? in->i_ptr->base : nullptr;
+            const MemberCache_t::Entry_t* entry = cache ? cache->lookup(owner, base) : nullptr;
+
+            if(entry){
+                Object* member = entry->member ? entry->member : &in->i_ptr->fields[entry->field];
+                intp.exprStack.emplace_back(
+                    entry->bind && member->type == ObjectType::FUNCTION
+                    ? makeMethod(in, member)
+                    : makeRef(*member)
+                );
+                return;
+            }
 
-                if(oit2 != in->i_ptr->objects.end()){
+            if(inMethod){
+                Object* member = findMember(in->i_ptr, id, cache);
+                if(member){
                     intp.exprStack.emplace_back(
-                        oit2->second.type == ObjectType::FUNCTION
-                        ? makeMethod(in, &oit2->second)
-                        : makeRef(oit2->second)
+                        member->type == ObjectType::FUNCTION
+                        ? makeMethod(in, member)
+                        : makeRef(*member)
                     );
                     return;
                 }
-
-                std::vector<Class*> to_check {in->i_ptr->base};
-                while(!to_check.empty()){
-                    Class* base = to_check.back();
-                    to_check.pop_back();
-
-                    oit2 = base->objects.find(id);
-                    if(oit2 != base->objects.end()){
-                        intp.exprStack.emplace_back(
-                            oit2->second.type == ObjectType::FUNCTION
-                            ? makeMethod(in, &oit2->second)
-                            : makeRef(oit2->second)
-                        );
-                        return;
-                    }
-                    to_check.insert(to_check.end(), base->bases.rbegin(), base->bases.rend());
-                }
             }
 
-            RootObjectDict_t& objects = intp.funcStack.back().box->objects;
-            oit = objects.find(id);
+            RootObjectDict_t& objects = callInfo.box->objects;
+            RootObjectDict_t::iterator oit = objects.find(id);
 
             if(oit == objects.end()){
                 intp.rt->sources.printStackTrace(intp, error::ET_ERROR,
                     std::string("cannot find symbol '")
                     + intp.rt->nameFromId(id) + "'");
             }
+
+            if(cache)
+                cache->store(owner, base, &oit->second.get(), 0, false);
             intp.exprStack.emplace_back(makeRef(oit->second));
         }
 
+        _OcFunc(PushRef){
+            unsigned id = runtime::idsStart + ((static_cast<uint16_t>(inst[1]) << 8) | inst[2]);
+            pushRefByName(intp, id, intp.locals.size(), memberCache(intp, inst));
+        }
+
+        _OcFunc(LoadLocal){
+            size_t idx = intp.funcStack.back().localsBase
+                + ((static_cast<uint16_t>(inst[1]) << 8) | inst[2]);
+
+            if(idx < intp.locals.size()){
+                LocalSlot_t& local = intp.locals[idx];
+                if(local.defined){
+                    intp.exprStack.emplace_back(makeRef(local.obj));
+                    return;
+                }
+            } else {
+                idx = intp.locals.size();
+            }
+
+            unsigned id = runtime::idsStart + ((static_cast<uint16_t>(inst[3]) << 8) | inst[4]);
+            pushRefByName(intp, id, idx, nullptr);
+        }
+
         _OcFunc(PushThis){
             intp.exprStack.emplace_back(intp.funcStack.back().thisObject);
         }
@@ -154,16 +233,23 @@ namespace sm{
             }
         }
 
-        _OcFunc(Find){
-            RootObject& ref = intp.exprStack.back();
+        // replaces 'ref' with its member named 'id' (used by FIND and CALL_METHOD).
+        inline void findIn(Interpreter& intp, RootObject& ref, unsigned id, MemberCache_t* cache) noexcept{
             RootObject obj = (ref->type == ObjectType::WEAK_REFERENCE
                     || ref->type == ObjectType::STRONG_REFERENCE) ? RootObject(ref->refGet()) : ref;
-            unsigned id = runtime::idsStart + ((static_cast<uint16_t>(inst[1]) << 8) | inst[2]);
 
             switch(obj->type){
                 case ObjectType::BOX: {
+                    const MemberCache_t::Entry_t* entry = cache ? cache->lookup(obj->b_ptr, nullptr) : nullptr;
+                    if(entry){
+                        ref = makeRef(*entry->member);
+                        return;
+                    }
+
                     RootObjectDict_t::iterator it = obj->b_ptr->objects.find(id);
                     if(it != obj->b_ptr->objects.end()){
+                        if(cache)
+                            cache->store(obj->b_ptr, nullptr, &it->second.get(), 0, false);
                         ref = makeRef(it->second);
                         return;
                     }
@@ -174,29 +260,13 @@ namespace sm{
                 }
 
                 case ObjectType::CLASS_INSTANCE: {
-                    ObjectDict_t::iterator it = obj->i_ptr->objects.find(id);
-                    if(it != obj->i_ptr->objects.end()){
-                        ref = it->second.type == ObjectType::FUNCTION
-                            ? makeMethod(obj, &it->second) : makeRef(it->second);
+                    Object* member = findMember(obj->i_ptr, id, cache);
+                    if(member){
+                        ref = member->type == ObjectType::FUNCTION
+                            ? makeMethod(obj, member) : makeRef(*member);
                         return;
                     }
 
-                    std::vector<Class*> to_check {obj->i_ptr->base};
-                    while(!to_check.empty()){
-                        Class* base = to_check.back();
-                        to_check.pop_back();
-
-                        it = base->objects.find(id);
-                        if(it != base->objects.end()){
-                            ref = it->second.type == ObjectType::FUNCTION
-                                ? makeMethod(obj, &it->second)
-                                : makeRef(it->second);
-                            return;
-                        }
-
-                        to_check.insert(to_check.end(), base->bases.rbegin(), base->bases.rend());
-                    }
-
                     intp.rt->sources.printStackTrace(intp, error::ET_ERROR,
                         std::string("cannot find '") + intp.rt->nameFromId(id)
                         + "' in " + runtime::errorString(intp, obj));
@@ -233,6 +303,11 @@ namespace sm{
             }
         }
 
+        _OcFunc(Find){
+            unsigned id = runtime::idsStart + ((static_cast<uint16_t>(inst[1]) << 8) | inst[2]);
+            findIn(intp, intp.exprStack.back(), id, memberCache(intp, inst));
+        }
+
         _OcFunc(Iterate){
             RootObject tos = intp.exprStack.back();
             _OcValue(tos);
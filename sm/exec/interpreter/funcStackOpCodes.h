@@ -21,6 +21,7 @@
 #define _SM__EXEC__INTERPPRETER__FUNCSTACKOPCODES_H
 
 #include "sm/exec/interpreter/defines.h"
+#include "sm/exec/interpreter/exprStackOpCodes.h"
 #include "sm/compile/defs.h"
 #include "sm/runtime/casts.h"
 #include "sm/runtime/id.h"
@@ -30,19 +31,18 @@ namespace sm{
         _OcFunc(Nop){}
 
         _OcFunc(StartBlock){
-            intp.funcStack.back().codeBlocks.emplace_back(nullptr);
+            intp.blocks.push_back(intp.locals.size());
         }
 
         _OcFunc(EndBlock){
-            RootObjectDict_t* ptr = intp.funcStack.back().codeBlocks.back();
-            intp.funcStack.back().codeBlocks.pop_back();
-            if(ptr)
-                delete ptr;
+            intp.locals.resize(intp.blocks.back());
+            intp.blocks.pop_back();
         }
 
         _OcFunc(Return){
             RootObject& back = intp.exprStack.back();
-            bool wasInlined = intp.funcStack.back().inlined, empty = intp.funcStack.size() == 1;
+            CallInfo_t& callInfo = intp.funcStack.back();
+            bool wasInlined = callInfo.inlined, empty = intp.funcStack.size() == 1;
 
             if(back->type == ObjectType::WEAK_REFERENCE){
                 back = back->refGet();
@@ -50,9 +50,8 @@ namespace sm{
                 back->type = ObjectType::WEAK_REFERENCE;
             }
 
-            RootObjectDictVec_t dictVec = std::move(intp.funcStack.back().codeBlocks);
-            for(RootObjectDictVec_t::iterator it = dictVec.begin(); it != dictVec.end(); ++it)
-                delete *it;
+            intp.locals.resize(callInfo.localsBase);
+            intp.blocks.resize(callInfo.blocksBase);
 
             intp.funcStack.pop_back();
             intp.doReturn = wasInlined || empty;
@@ -62,12 +61,11 @@ namespace sm{
         }
 
         _OcFunc(ReturnNull){
-            bool wasInlined = intp.funcStack.back().inlined, empty = intp.funcStack.size() == 1;
+            CallInfo_t& callInfo = intp.funcStack.back();
+            bool wasInlined = callInfo.inlined, empty = intp.funcStack.size() == 1;
 
-            RootObjectDictVec_t dictVec = std::move(intp.funcStack.back().codeBlocks);
-            for(RootObjectDictVec_t::iterator it = dictVec.begin(); it != dictVec.end(); ++it){
-                delete *it;
-            }
+            intp.locals.resize(callInfo.localsBase);
+            intp.blocks.resize(callInfo.blocksBase);
 
             intp.funcStack.pop_back();
             intp.exprStack.emplace_back(nullptr);
@@ -79,18 +77,10 @@ namespace sm{
 
         _OcFunc(EndBlocks){
             unsigned param = (static_cast<uint16_t>(inst[1]) << 8) | inst[2];
+            std::vector<size_t>::iterator first = intp.blocks.end() - param;
 
-            RootObjectDictVec_t& vec = intp.funcStack.back().codeBlocks;
-            RootObjectDictVec_t::iterator end = vec.end();
-            RootObjectDictVec_t::iterator last = end - param;
-            RootObjectDict_t* ptr;
-
-            while(end != last){
-                ptr = *(--end);
-                vec.pop_back();
-                if(ptr)
-                    delete ptr;
-            }
+            intp.locals.resize(*first);
+            intp.blocks.erase(first, intp.blocks.end());
         }
 
         _OcFunc(Try){
@@ -108,30 +98,13 @@ namespace sm{
         _OcFunc(CallFunction){
             unsigned param = (static_cast<uint16_t>(inst[1]) << 8) | inst[2];
 
-            RootObjectVec_t::iterator end = intp.exprStack.end();
-            RootObject func = *(end -param -1);
-            Function* func_ptr;
-
-            RootObjectVec_t args(
-                    std::make_move_iterator(end - param),
-                    std::make_move_iterator(end)
-            );
-            intp.exprStack.erase(end -param -1, end);
-
-            for(Object& obj : args){
-                if(obj.type == ObjectType::WEAK_REFERENCE){
-                    obj = obj.refGet();
-                } else if(obj.type == ObjectType::STRONG_REFERENCE){
-                    obj.type = ObjectType::WEAK_REFERENCE;
-                }
-            }
-
+            RootObject obj = *(intp.exprStack.end() -param -1);
             RootObject self;
-            RootObject obj = func;
+            Function* func_ptr;
             _OcValue(obj);
 
             if(runtime::callable(obj, self, func_ptr)){
-                intp.makeCall(func_ptr, args, self);
+                intp.makeStackCall(func_ptr, param, self);
             } else {
                 intp.rt->sources.printStackTrace(intp, error::ET_ERROR,
                     std::string("cannot invoke 'operator()()' in ")
@@ -139,29 +112,54 @@ namespace sm{
             }
         }
 
-        _OcFunc(PerformBracing){
-            unsigned param = (static_cast<uint16_t>(inst[1]) << 8) | inst[2];
+        _OcFunc(CallMethod){
+            unsigned id = runtime::idsStart + ((static_cast<uint16_t>(inst[1]) << 8) | inst[2]);
+            unsigned param = (static_cast<uint16_t>(inst[3]) << 8) | inst[4];
+
+            RootObject& ref = *(intp.exprStack.end() -param -1);
+            RootObject obj = (ref->type == ObjectType::WEAK_REFERENCE
+                    || ref->type == ObjectType::STRONG_REFERENCE) ? RootObject(ref->refGet()) : ref;
+            MemberCache_t* cache = memberCache(intp, inst);
+
+            // common cases: the method is called without creating a Method object.
+            if(obj->type == ObjectType::CLASS_INSTANCE){
+                Object* member = findMember(obj->i_ptr, id, cache);
+                if(member && member->type == ObjectType::FUNCTION){
+                    intp.makeStackCall(member->f_ptr, param, obj);
+                    return;
+                }
+            } else if(obj->type == ObjectType::STRING){
+                ObjectDict_t::iterator it = lib::cString->objects.find(id);
+                if(it != lib::cString->objects.end() && it->second.type == ObjectType::FUNCTION){
+                    intp.makeStackCall(it->second.f_ptr, param, obj);
+                    return;
+                }
+            }
+
+            // otherwise, like FIND followed by CALL_FUNCTION.
+            findIn(intp, ref, id, cache);
 
-            RootObjectVec_t::iterator end = intp.exprStack.end();
-            RootObject tosX = *(end - (param+1));
+            RootObject func = *(intp.exprStack.end() -param -1);
+            RootObject self;
             Function* func_ptr;
+            _OcValue(func);
 
-            RootObjectVec_t args(
-                std::make_move_iterator(end - param),
-                std::make_move_iterator(end)
-            );
-            intp.exprStack.erase(end - (param+1), end);
-
-            for(Object& obj : args){
-                if(obj.type == ObjectType::WEAK_REFERENCE){
-                    obj = obj.refGet();
-                } else if(obj.type == ObjectType::STRONG_REFERENCE){
-                    obj.type = ObjectType::WEAK_REFERENCE;
-                }
+            if(runtime::callable(func, self, func_ptr)){
+                intp.makeStackCall(func_ptr, param, self);
+            } else {
+                intp.rt->sources.printStackTrace(intp, error::ET_ERROR,
+                    std::string("cannot invoke 'operator()()' in ")
+                    + runtime::errorString(intp, func));
             }
+        }
+
+        _OcFunc(PerformBracing){
+            unsigned param = (static_cast<uint16_t>(inst[1]) << 8) | inst[2];
 
+            RootObject tosX = *(intp.exprStack.end() - (param+1));
             RootObject self;
             RootObject func;
+            Function* func_ptr;
             _OcValue(tosX);
 
             if(!runtime::find_any(tosX, func, runtime::squareId)){
@@ -171,7 +169,7 @@ namespace sm{
             }
 
             if(runtime::callable(func, self = tosX, func_ptr)){
-                intp.makeCall(func_ptr, args, self);
+                intp.makeStackCall(func_ptr, param, self);
             } else {
                 intp.rt->sources.printStackTrace(intp, error::ET_ERROR,
                     std::string("'operator[]()' is not a function in ")
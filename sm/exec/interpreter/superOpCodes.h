@@ -0,0 +1,191 @@
+/*
+ *      Copyright 2016-2017 Riccardo Musso
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ *
+ *      File exec/interpreter/superOpCodes.h
+ *
+*/
+
+#ifndef _SM__EXEC__INTERPRETER__SUPEROPCODES_H
+#define _SM__EXEC__INTERPRETER__SUPEROPCODES_H
+
+#include "sm/exec/interpreter/defines.h"
+#include "sm/exec/interpreter/compareOpCodes.h"
+#include "sm/exec/interpreter/exprStackOpCodes.h"
+#include "sm/compile/Statement.h"
+
+/*
+ * Superinstructions are made by Interpreter::decode(), their params are:
+ *  inst[1..4]  params of the first instruction (if it's LOAD_LOCAL)
+ *  inst[5]     opcode of the operator (compare, math or INC/DEC)
+ *  inst[6..7]  param of JUMP_IF_NOT_F
+ *  inst[8]     kind of the second operand (SuperOperand_t)
+ *  inst[9..10] second operand: slot, int16 value or id of the int constant
+ *  inst[11]    size of the instructions following the first one
+ *
+ * When the operands aren't integers, only the first instruction
+ * is run and the other ones follow from their own entries.
+*/
+
+namespace sm{
+    namespace exec{
+        enum SuperOperand_t : uint8_t {
+            SO_LOCAL,
+            SO_VALUE,
+            SO_CONSTANT
+        };
+
+        // the local in 'slot' if it's a defined integer, nullptr otherwise.
+        inline Object* integerLocal(Interpreter& intp, unsigned slot) noexcept{
+            size_t idx = intp.funcStack.back().localsBase + slot;
+            if(idx < intp.locals.size()){
+                LocalSlot_t& local = intp.locals[idx];
+                if(local.defined && local.obj->type == ObjectType::INTEGER)
+                    return &local.obj.get();
+            }
+            return nullptr;
+        }
+
+        inline bool integerOperand(Interpreter& intp, const InstBytes_t& inst, integer_t& out) noexcept{
+            uint16_t param = (static_cast<uint16_t>(inst[9]) << 8) | inst[10];
+            switch(inst[8]){
+                case SO_LOCAL: {
+                    Object* local = integerLocal(intp, param);
+                    if(!local)
+                        return false;
+                    out = local->i;
+                    return true;
+                }
+
+                case SO_VALUE:
+                    out = static_cast<int16_t>(param);
+                    return true;
+
+                default:
+                    out = intp.rt->intConstants[param];
+                    return true;
+            }
+        }
+
+        inline bool compareIntegers(uint8_t op, integer_t a, integer_t b) noexcept{
+            switch(op){
+                case compile::EQUAL: return a == b;
+                case compile::NOT_EQUAL: return a != b;
+                case compile::GREATER: return a > b;
+                case compile::GREATER_OR_EQUAL: return a >= b;
+                case compile::LESS: return a < b;
+                default: return a <= b;
+            }
+        }
+
+        // false if 'op' has to be done by its own handler (division by zero).
+        inline bool mathIntegers(uint8_t op, integer_t a, integer_t b, integer_t& out) noexcept{
+            switch(op){
+                case compile::ADD: out = a + b; return true;
+                case compile::SUB: out = a - b; return true;
+                case compile::MUL: out = a * b; return true;
+                case compile::DIV: if(!b) return false; out = a / b; return true;
+                case compile::MOD: if(!b) return false; out = a % b; return true;
+                case compile::OR: out = a | b; return true;
+                case compile::AND: out = a & b; return true;
+                default: out = a ^ b; return true;
+            }
+        }
+
+        inline void loadLocalOnly(Interpreter& intp, const InstBytes_t& inst) noexcept{
+            intp.pc -= inst[11];
+            LoadLocal(intp, inst);
+        }
+
+        _OcFunc(CmpJumpIfNotF){
+            size_t sz = intp.exprStack.size();
+            const Object* tos1 = &intp.exprStack[sz-2].get();
+            const Object* tos = &intp.exprStack[sz-1].get();
+
+            while(tos1->type == ObjectType::WEAK_REFERENCE || tos1->type == ObjectType::STRONG_REFERENCE)
+                tos1 = tos1->o_ptr;
+            while(tos->type == ObjectType::WEAK_REFERENCE || tos->type == ObjectType::STRONG_REFERENCE)
+                tos = tos->o_ptr;
+
+            if(tos1->type == ObjectType::INTEGER && tos->type == ObjectType::INTEGER){
+                bool result = compareIntegers(inst[5], tos1->i, tos->i);
+                intp.exprStack.resize(sz-2);
+                if(!result)
+                    intp.pc += ((static_cast<uint16_t>(inst[6]) << 8) | inst[7]) -1;
+                return;
+            }
+
+            intp.pc -= inst[11];
+            switch(inst[5]){
+                case compile::EQUAL: Equal(intp, {}); break;
+                case compile::NOT_EQUAL: NotEqual(intp, {}); break;
+                case compile::GREATER: Greater(intp, {}); break;
+                case compile::GREATER_OR_EQUAL: GreaterOrEqual(intp, {}); break;
+                case compile::LESS: Less(intp, {}); break;
+                default: LessOrEqual(intp, {}); break;
+            }
+        }
+
+        _OcFunc(LocalCmpJumpIfNotF){
+            Object* local = integerLocal(intp, (static_cast<uint16_t>(inst[1]) << 8) | inst[2]);
+            integer_t rhs;
+
+            if(local && integerOperand(intp, inst, rhs)){
+                if(!compareIntegers(inst[5], local->i, rhs))
+                    intp.pc += ((static_cast<uint16_t>(inst[6]) << 8) | inst[7]) -1;
+                return;
+            }
+            loadLocalOnly(intp, inst);
+        }
+
+        _OcFunc(LocalOp){
+            Object* local = integerLocal(intp, (static_cast<uint16_t>(inst[1]) << 8) | inst[2]);
+            integer_t rhs, result;
+
+            if(local && integerOperand(intp, inst, rhs)
+                    && mathIntegers(inst[5], local->i, rhs, result)){
+                intp.exprStack.emplace_back(makeInteger(result));
+                return;
+            }
+            loadLocalOnly(intp, inst);
+        }
+
+        _OcFunc(LocalAssignOpPop){
+            Object* local = integerLocal(intp, (static_cast<uint16_t>(inst[1]) << 8) | inst[2]);
+            integer_t rhs, result;
+
+            if(local && integerOperand(intp, inst, rhs)
+                    && mathIntegers(inst[5], local->i, rhs, result)){
+                local->i = result;
+                return;
+            }
+            loadLocalOnly(intp, inst);
+        }
+
+        _OcFunc(LocalIncPop){
+            Object* local = integerLocal(intp, (static_cast<uint16_t>(inst[1]) << 8) | inst[2]);
+
+            if(local){
+                if(inst[5] == compile::INC || inst[5] == compile::POST_INC)
+                    ++local->i;
+                else
+                    --local->i;
+                return;
+            }
+            loadLocalOnly(intp, inst);
+        }
+    }
+}
+
+#endif
@@ -43,7 +43,7 @@ namespace sm {
     namespace io {
         constexpr char magic [] = "\xC0\xDE\xC0\x00L";
         constexpr size_t magic_size = arraySize(magic);
-        constexpr uint32_t format_version = 1;
+        constexpr uint32_t format_version = 5;
 
         // Sz -> For serialize purposes
         using SzBool_t = uint8_t;
@@ -216,6 +216,20 @@ sm::Writer<Tp>& operator<<(sm::Writer<Tp>& out, sm::runtime::Runtime_t& rt) noex
     // code
     out << rt.code;
 
+    // source lines (see compile/LineTable.h) and names of the sources
+    {
+        ByteCode_t lines = rt.lines.data();
+        out << lines;
+
+        out.template write<SzSize_t>(rt.sources.size());
+        for(unsigned i = 0; i != rt.sources.size(); ++i){
+            error::CodeSource* src = rt.sources.getSource(i);
+            string_t name = src ? src->sourceName : string_t();
+            out.template write<SzSize_t>(name.size());
+            out.write_str(name.data(), name.size());
+        }
+    }
+
     // boxes
     out.template write<SzSize_t>(rt.boxes.size());
     for(size_t i = 0; i != rt.boxes.size(); ++i){
@@ -355,6 +369,26 @@ sm::Reader<Tp>& operator>>(sm::Reader<Tp>& in, sm::runtime::Runtime_t& rt) noexc
     // code
     in >> rt.code;
 
+    // source lines
+    {
+        ByteCode_t lines;
+        in >> lines;
+        rt.lines.assign(std::move(lines));
+
+        SzSize_t size = in.template read<SzSize_t>();
+        while(size--){
+            SzSize_t strSize = in.template read<SzSize_t>();
+            error::CodeSource* src = nullptr;
+
+            if(strSize){
+                src = new error::CodeSource;
+                src->sourceName.resize(strSize);
+                in.read_str(reinterpret_cast<byte_t*>(&src->sourceName[0]), strSize);
+            }
+            rt.sources.newSource(src);
+        }
+    }
+
     // boxes
     {
         SzSize_t size = in.template read<SzSize_t>();
@@ -78,7 +78,7 @@ namespace sm{
                 unicode_t ch = uByCodepoint(cp);
                 if(ch == UTF8_ERROR)
                     return Object();
-                return makeString(ch);
+                return makeCharString(ch);
             })
 
             smFunc(ucode, smLambda {
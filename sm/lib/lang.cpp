@@ -34,6 +34,7 @@ namespace sm{
         Class* cTable = nullptr;
         Class* cListIterator = nullptr;
         Class* cStringIterator = nullptr;
+        Class* cStringBuilder = nullptr;
 
         namespace StringClass {}
         namespace ListClass {}
@@ -43,6 +44,7 @@ namespace sm{
         }
         namespace ListIteratorClass {}
         namespace StringIteratorClass {}
+        namespace StringBuilderClass {}
 
         smLibDecl(lang){
             smInitBox
@@ -173,7 +175,7 @@ namespace sm{
                         String::iterator ch_it = String::nthChar(begin, end, i);
                         return makeInteger(std::distance(begin, ch_it));
                     } else if(i < 0){
-                        integer_t n = self->s_ptr->str.uSize() + i;
+                        integer_t n = self->s_ptr->uSize() + i;
                         if(n <= 0)
                             return Object();
                         String::iterator ch_it = String::nthChar(begin, end, n);
@@ -251,20 +253,20 @@ namespace sm{
                     if(self->s_ptr->str.empty())
                         return Object();
                     if(args.empty()){
-                        return makeString(begin, begin+1);
+                        return makeByteString(*begin);
                     } else if(args[0]->type == ObjectType::INTEGER){
                         integer_t idx = args[0]->i;
                         if(idx >= 0){
                             size_t i = static_cast<size_t>(idx);
                             if(i >= self->s_ptr->str.size())
                                 return Object();
-                            return makeString(begin+i, begin+i+1);
+                            return makeByteString(begin[i]);
                         }
 
                         idx += static_cast<integer_t>(self->s_ptr->str.size());
                         if(idx < 0)
                             return Object();
-                        return makeString(begin+idx, begin+idx+1);
+                        return makeByteString(begin[idx]);
                     }
                     return Object();
                 })
@@ -272,21 +274,21 @@ namespace sm{
                 smMethod(u_get, smLambda {
                     if(self->s_ptr->str.empty())
                         return Object();
-                    integer_t strSize = self->s_ptr->str.uSize();
+                    integer_t strSize = self->s_ptr->uSize();
                     if(args.empty()){
-                        return makeString(self->s_ptr->str.uCharAt(0));
+                        return makeCharString(self->s_ptr->str.uCharAt(0));
                     } else if(args[0]->type == ObjectType::INTEGER){
                         integer_t idx = args[0]->i;
                         if(idx >= 0){
                             if(idx >= strSize)
                                 return Object();
-                            return makeString(self->s_ptr->str.uCharAt(idx));
+                            return makeCharString(self->s_ptr->str.uCharAt(idx));
                         }
 
                         idx += strSize;
                         if(idx < 0)
                             return Object();
-                        return makeString(self->s_ptr->str.uCharAt(idx));
+                        return makeCharString(self->s_ptr->str.uCharAt(idx));
                     }
                     return Object();
                 })
@@ -316,7 +318,7 @@ namespace sm{
                 smMethod(u_getc, smLambda {
                     if(self->s_ptr->str.empty())
                         return Object();
-                    integer_t strSize = self->s_ptr->str.uSize();
+                    integer_t strSize = self->s_ptr->uSize();
                     if(args.empty()){
                         return makeInteger(uGetCodepoint(self->s_ptr->str.uCharAt(0)));
                     } else if(args[0]->type == ObjectType::INTEGER){
@@ -402,7 +404,7 @@ namespace sm{
                 })
 
                 smMethod(hash, smLambda {
-                    return makeInteger(self->s_ptr->str.hash());
+                    return makeInteger(self->s_ptr->hash());
                 })
 
                 smMethod(find, smLambda {
@@ -460,7 +462,7 @@ namespace sm{
                         return Object();
                     }
 
-                    integer_t size = self->s_ptr->str.uSize();
+                    integer_t size = self->s_ptr->uSize();
                     integer_t start = args[0]->i;
 
                     if(!runtime::findIndex(start, start, size))
@@ -1630,7 +1632,7 @@ namespace sm{
                     if(check && String::uNext(it, ref.end(), ch)){
                         i = it - ref.begin();
                         return makeTuple(intp, {
-                            makeString(ch), makeTrue()
+                            makeCharString(ch), makeTrue()
                         });
                     }
 
@@ -1638,6 +1640,68 @@ namespace sm{
                 })
             smEnd
 
+            smClass(StringBuilder)
+                /*
+                 *
+                 *       .d8888b.   888              d8b                      888888b.              d8b  888       888
+                 *      d88P  Y88b  888              Y8P                      888  "88b             Y8P  888       888
+                 *      Y88b.       888                                       888  .88P                  888       888
+                 *       "Y888b.    888888  888d888  888  88888b.    .d88b.   8888888K.   888  888  888  888   .d88888   .d88b.   888d888
+                 *          "Y88b.  888     888P"    888  888 "88b  d88P"88b  888  "Y88b  888  888  888  888  d88" 888  d8P  Y8b  888P"
+                 *            "888  888     888      888  888  888  888  888  888    888  888  888  888  888  888  888  88888888  888
+                 *      Y88b  d88P  Y88b.   888      888  888  888  Y88b 888  888   d88P  Y88b 888  888  888  Y88b 888  Y8b.      888
+                 *       "Y8888P"    "Y888  888      888  888  888   "Y88888  8888888P"    "Y88888  888  888   "Y88888   "Y8888   888
+                 *                                                       888
+                 *                                                  Y8b d88P
+                 *                                                   "Y88P"
+                */
+
+                smMethod(new, smLambda {
+                    String* ptr = smSetData(String) = new String();
+                    for(const RootObject& obj : args){
+                        Object str = runtime::implicitToString(intp, obj);
+                        ptr->append(str.s_ptr->str);
+                    }
+                    return Object();
+                })
+
+                smMethod(delete, smLambda {
+                    smDeleteData(String);
+                    return Object();
+                })
+
+                smIdMethod(runtime::gcCollectId, smLambda {
+                    smDeleteData(String);
+                    return Object();
+                })
+
+                smMethod(append, smLambda {
+                    String* ptr = smGetData(String);
+                    for(const RootObject& obj : args){
+                        Object str = runtime::implicitToString(intp, obj);
+                        ptr->append(str.s_ptr->str);
+                    }
+                    return Object();
+                })
+
+                smMethod(len, smLambda {
+                    return makeInteger(smGetData(String)->size());
+                })
+
+                smMethod(empty, smLambda {
+                    return makeBool(smGetData(String)->empty());
+                })
+
+                smMethod(clear, smLambda {
+                    smGetData(String)->clear();
+                    return Object();
+                })
+
+                smMethod(to_string, smLambda {
+                    return makeString(*smGetData(String));
+                })
+            smEnd
+
             smReturnBox
         }
     }
@@ -1654,6 +1718,34 @@ namespace sm{
         return tuple;
     }
 
+    RootObject makeTable(exec::Interpreter& intp,
+            const std::vector<std::pair<RootObject, RootObject>>& entries) noexcept{
+        RootObject table = newInstance(intp, lib::cTable);
+        lib::TableClass::Table_t* ptr = lib::getData<lib::TableClass::Table_t>(intp, table);
+        for(const std::pair<RootObject, RootObject>& entry : entries)
+            (*ptr)[entry.first] = entry.second;
+        return table;
+    }
+
+    Object makeByteString(unsigned char ch) noexcept{
+        static const std::vector<Object> strings = []{
+            std::vector<Object> vec;
+            vec.reserve(256);
+            for(unsigned i = 0; i != 256; ++i){
+                char byte = static_cast<char>(i);
+                vec.emplace_back(makeString(&byte, &byte + 1));
+            }
+            return vec;
+        }();
+        return strings[ch];
+    }
+
+    Object makeCharString(unicode_t ch) noexcept{
+        if(ch && ch < 0x80)
+            return makeByteString(static_cast<unsigned char>(ch));
+        return makeString(ch);
+    }
+
     bool hasVector(exec::Interpreter& intp, const Object& obj, ObjectVec_t*& vecPtr) noexcept{
         if(runtime::of_type(obj, lib::cList) || runtime::of_type(obj, lib::cTuple)){
             vecPtr = lib::getData<ObjectVec_t>(intp, obj);
@@ -125,10 +125,10 @@
     delete ptr;
 
 #define smHas(Id) \
-    (self->i_ptr->objects.find(Id) != self->i_ptr->objects.end())
+    (self->i_ptr->field(Id) != nullptr)
 
 #define smRef(Id) \
-    (static_cast<Object&>(self->i_ptr->objects[Id]))
+    (self->i_ptr->fieldRef(Id))
 
 namespace sm {
     namespace lib {
@@ -146,7 +146,7 @@ namespace sm {
 
         template <typename Tp>
         inline Tp*& data(const Object& obj){
-            return reinterpret_cast<Tp*&>(obj.i_ptr->objects[runtime::dataId].ptr);
+            return reinterpret_cast<Tp*&>(obj.i_ptr->fieldRef(runtime::dataId).ptr);
         }
 
         template <typename Tp>
@@ -96,6 +96,57 @@ namespace sm {
                 return data<ChunkClass::ChunkData>(inst) ? inst : RootObject();
             })
 
+            smFunc(gc_collect, smLambda {
+                intp.rt->gc.collect();
+                return Object();
+            })
+
+            smFunc(gc_budget, smLambda {
+                runtime::GarbageCollector& gc = intp.rt->gc;
+                integer_t old = gc.budget;
+                if(!args.empty() && args[0]->type == ObjectType::INTEGER && args[0]->i >= 0)
+                    gc.budget = args[0]->i;
+                return makeInteger(old);
+            })
+
+            smFunc(gc_growth, smLambda {
+                runtime::GarbageCollector& gc = intp.rt->gc;
+                integer_t old = gc.growth;
+                if(!args.empty() && args[0]->type == ObjectType::INTEGER && args[0]->i >= 0)
+                    gc.growth = args[0]->i;
+                return makeInteger(old);
+            })
+
+            smFunc(gc_min, smLambda {
+                runtime::GarbageCollector& gc = intp.rt->gc;
+                integer_t old = gc.minThreshold;
+                if(!args.empty() && args[0]->type == ObjectType::INTEGER && args[0]->i > 0){
+                    gc.minThreshold = args[0]->i;
+                    if(gc.threshold < gc.minThreshold)
+                        gc.threshold = gc.minThreshold;
+                }
+                return makeInteger(old);
+            })
+
+            smFunc(gc_stats, smLambda {
+                runtime::GCStats stats = intp.rt->gc.stats();
+                std::vector<std::pair<RootObject, RootObject>> classes;
+                for(const std::pair<string_t, size_t>& pair : stats.classes)
+                    classes.emplace_back(makeString(pair.first.c_str()), makeInteger(pair.second));
+
+                return makeTable(intp, {
+                    {makeString("made"), makeInteger(stats.made)},
+                    {makeString("collections"), makeInteger(stats.collections)},
+                    {makeString("minor_collections"), makeInteger(stats.minorCollections)},
+                    {makeString("steps"), makeInteger(stats.steps)},
+                    {makeString("pause_total"), makeInteger(stats.pauseTotal)},
+                    {makeString("pause_max"), makeInteger(stats.pauseMax)},
+                    {makeString("alive"), makeInteger(stats.alive)},
+                    {makeString("heap"), makeInteger(stats.heap)},
+                    {makeString("classes"), makeTable(intp, classes)}
+                });
+            })
+
             smClass(Chunk)
 
                 /*
@@ -41,6 +41,14 @@ namespace sm{
 
                 td.data->intp.callFunction(f_ptr, td.data->args, self, false);
 
+                /*
+                 * released before locking threads_m: releasing an instance can
+                 * wait for a collection, which can look for this thread.
+                 */
+                self = RootObject();
+                td.data->func = RootObject();
+                td.data->args.clear();
+
                 runtime::Runtime_t* rt = td.data->intp.rt;
                 exec::TWrapper* wrapper = td.wrapper;
                 std::lock_guard<std::mutex> lock(rt->threads_m);
@@ -52,6 +60,9 @@ namespace sm{
                         wrapper->th.detach();
                     delete wrapper;
                     --rt->n_threads;
+                } else {
+                    // the interpreter is gone, the thread is still in the map until it's deleted.
+                    rt->threads[std::this_thread::get_id()].data = nullptr;
                 }
             }
         }
@@ -116,6 +127,7 @@ namespace sm{
                         ++intp.rt->n_threads;
 
                         smSetData(exec::TWrapper) = td.wrapper;
+                        runtime::threaded.store(true, std::memory_order_release); // from now on objects can be shared
                         td.wrapper->th = std::thread(wrapper_func, td);
 
                         // threads_m is not released yet, so:
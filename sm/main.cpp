@@ -43,6 +43,7 @@
 #include <fstream>
 #include <cstring>
 #include <cstdlib>
+#include <climits>
 #include <chrono>
 #include <thread>
 
@@ -90,7 +91,24 @@ int main(int argc, char** argv){
         for(int i = 1; i != argc; ++i){
             if(*argv[i] == '-'){
                 argv[i]++;
-                if(!std::strcmp(argv[i], "c")){
+                if(!std::strcmp(argv[i], "b")){
+                    if(++i == argc || *argv[i] == '-'){
+                        printUsage();
+                        return 0;
+                    }
+
+                    try {
+                        unsigned long n = std::stoul(argv[i]);
+                        if(n > UINT_MAX){
+                            printUsage();
+                            return 0;
+                        }
+                        rt.gc.budget = n;
+                    } catch(...){
+                        printUsage();
+                        return 0;
+                    }
+                } else if(!std::strcmp(argv[i], "c")){
                     rt.compileOnly = true;
                 } else if(!std::strcmp(argv[i], "D")){
                     if(++i == argc || *argv[i] == '-'){
@@ -110,6 +128,48 @@ int main(int argc, char** argv){
                         printUsage();
                         return 0;
                     }
+                } else if(!std::strcmp(argv[i], "F")){
+                    if(++i == argc || *argv[i] == '-'){
+                        printUsage();
+                        return 0;
+                    }
+
+                    delete rt.sampler;
+                    rt.sampler = new exec::StackSampler(argv[i]);
+                } else if(!std::strcmp(argv[i], "g")){
+                    if(++i == argc || *argv[i] == '-'){
+                        printUsage();
+                        return 0;
+                    }
+
+                    try {
+                        unsigned long n = std::stoul(argv[i]);
+                        if(!n || n > UINT_MAX){
+                            printUsage();
+                            return 0;
+                        }
+                        rt.gc.threshold = rt.gc.minThreshold = n;
+                    } catch(...){
+                        printUsage();
+                        return 0;
+                    }
+                } else if(!std::strcmp(argv[i], "G")){
+                    if(++i == argc || *argv[i] == '-'){
+                        printUsage();
+                        return 0;
+                    }
+
+                    try {
+                        unsigned long n = std::stoul(argv[i]);
+                        if(n > UINT_MAX){
+                            printUsage();
+                            return 0;
+                        }
+                        rt.gc.growth = n;
+                    } catch(...){
+                        printUsage();
+                        return 0;
+                    }
                 } else if(!std::strcmp(argv[i], "i") || !std::strcmp(argv[i], "-stdin")){
                     std::string* code = new std::string;
                     std::string line;
@@ -133,8 +193,13 @@ int main(int argc, char** argv){
                 } else if(!std::strcmp(argv[i], "l") || !std::strcmp(argv[i], "-license")){
                     printLicense();
                     return 0;
+                } else if(!std::strcmp(argv[i], "M") || !std::strcmp(argv[i], "-gc-stats")){
+                    rt.gcStats = &rt.gc;
                 } else if(!std::strcmp(argv[i], "n") || !std::strcmp(argv[i], "-no-stdlib")){
                     rt.noStd = true;
+                } else if(!std::strcmp(argv[i], "P") || !std::strcmp(argv[i], "-profile")){
+                    if(!rt.opProfile)
+                        rt.opProfile = new exec::OpProfile_t;
                 } else if(!std::strcmp(argv[i], "s") || !std::strcmp(argv[i], "-show-paths")){
                     printPaths = true;
                 } else if(!std::strcmp(argv[i], "S") || !std::strcmp(argv[i], "-show-all")){
@@ -278,6 +343,9 @@ int main(int argc, char** argv){
         }
     #endif
 
+    if(rt.sampler)
+        rt.sampler->start(rt);
+
     #ifndef _SM_WIN_EMBED
     if(callInit)
     #endif
@@ -363,6 +431,9 @@ int main(int argc, char** argv){
     while(rt.n_threads.load())
         std::this_thread::yield();
 
+    if(rt.sampler)
+        rt.sampler->stop();
+
     rt.freeData();
     rt.main_intp = nullptr;
     return return_value;
@@ -380,14 +451,25 @@ int main(int argc, char** argv){
         "Also, you can replace [File] with option -i to use stdin instead.\n\n"
 
         "Options:\n"
+        "  -b <microseconds>        Let each step of a garbage collection last at most\n"
+        "                           <microseconds> (default 0: collect at once).\n"
         "  -c, --compile            Output bytecode to file an SMK file.\n"
         "  -D <directory>           Add <directory> to the search paths.\n"
         "  -e <n>                   Display <n> elements when stack is printed.\n"
+        "  -F <File>                Sample the call stacks and write them to <File>\n"
+        "                           (collapsed, for flame graphs).\n"
+        "  -g <n>                   Let at least <n> (> 0) new instances be made between\n"
+        "                           garbage collections (default 100).\n"
+        "  -G <percent>             Collect garbage again when the instances grow by <percent>\n"
+        "                           of the ones left by the last collection (default 100,\n"
+        "                           0 to collect every <n> instances of -g).\n"
         "  -h, --help               Display this information.\n"
         "  -i, --stdin              Get code to interpret from stdin.\n"
         "  -I <File>                Read SMK file <File> and execute it.\n"
         "  -l, --license            Display license.\n"
+        "  -M, --gc-stats           Show garbage collector statistics before exiting.\n"
         "  -n, --no-stdlib          Don't use native SSL (except for std.lang)\n"
+        "  -P, --profile            Show opcode counts and times before exiting.\n"
         "  -s, --show-paths         Display search paths.\n"
         "  -S, --show-all           Show all outputs.\n"
         "  -t, --time               Show total execution time before exiting.\n"
@@ -22,12 +22,14 @@
 
 #include <vector>
 #include <atomic>
+#include <memory>
 #include <cstddef>
 #include <utility>
 #include <ostream>
 #include <iostream>
 #include <map>
 #include <array>
+#include <mutex>
 
 #include "sm/typedefs.h"
 #include "sm/compile/Statement.h"
@@ -53,6 +55,32 @@ namespace sm{
     namespace runtime{
         class GarbageCollector;
         class Runtime_t;
+        struct Region;
+
+        /*
+         * false until std.thread starts the first thread: till then
+         * the reference counts (rcount) are only changed
+         * by this one, so they don't need locked instructions.
+         * It's stored (release) before the new thread is started and never
+         * reset; the spawned thread sees it through the thread start.
+         */
+        extern std::atomic<bool> threaded;
+
+        inline void refInc(std::atomic_uint& count) noexcept{
+            if(threaded.load(std::memory_order_relaxed))
+                ++count;
+            else
+                count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        // returns the count left.
+        inline unsigned refDec(std::atomic_uint& count) noexcept{
+            if(threaded.load(std::memory_order_relaxed))
+                return --count;
+            unsigned left = count.load(std::memory_order_relaxed) - 1;
+            count.store(left, std::memory_order_relaxed);
+            return left;
+        }
     }
 
     namespace exec{
@@ -80,7 +108,6 @@ namespace sm{
     using NativeFuncPtr_t = RootObject (*) (exec::Interpreter&, Function*, const RootObject&, const RootObjectVec_t&);
     using BoxVec_t = std::vector<Box*>;
     using ClassVec_t = std::vector<Class*>;
-    using InstanceList_t = std::list<Instance>;
     using GCSearchFunc_t = void (*) (const Object&, ObjectVec_t&);
 
     constexpr std::nullptr_t nullobj = nullptr;
@@ -129,6 +156,7 @@ namespace sm{
         };
 
         enum_t type;
+        bool rootRef = false; // if it's a reference to the object of a RootObject
 
         Object() noexcept;
         Object(enum_t tp) noexcept : type(tp) {}
@@ -152,22 +180,47 @@ namespace sm{
         ~Object();
     };
 
+    /*
+     * The value and its type side by side: integers take all
+     * the 64 bits of integer_t and 'type' is read and written
+     * as a field everywhere, so Object isn't NaN-boxed. It must
+     * stay two words, as the stacks and lists are made of it:
+     * the 8 bytes of the value, then 'type' and 'rootRef' (one
+     * byte each) in what was padding after 'type' already, which
+     * leaves 6 bytes for other flags. 16 bytes is the size Object
+     * has always had, rootRef didn't make it grow.
+     */
+    static_assert(sizeof(Object) <= 2 * sizeof(integer_t), "Object must not grow");
+
+    /*
+     * An object held by an interpreter's stacks or by native code.
+     * It's counted as any other reference: the collector finds
+     * the roots from the counts (see GarbageCollector::countRefs()),
+     * so pushing and popping it costs just its rcount.
+     */
     class RootObject {
     private:
         Object obj;
     public:
         RootObject() noexcept = default;
-        RootObject(const Object&) noexcept;
-        RootObject(Object&&) noexcept;
+        RootObject(const Object& rhs) noexcept : obj(rhs) {}
+        RootObject(Object&& rhs) noexcept : obj(std::move(rhs)) {}
+
+        RootObject(const RootObject&) noexcept = default;
+        RootObject(RootObject&&) noexcept = default;
 
-        RootObject(const RootObject&) noexcept;
-        RootObject(RootObject&&) noexcept;
+        RootObject& operator=(const Object& rhs) noexcept{
+            obj = rhs;
+            return *this;
+        }
 
-        RootObject& operator=(const Object&) noexcept;
-        RootObject& operator=(Object&&) noexcept;
+        RootObject& operator=(Object&& rhs) noexcept{
+            obj = std::move(rhs);
+            return *this;
+        }
 
-        RootObject& operator=(const RootObject&) noexcept;
-        RootObject& operator=(RootObject&&) noexcept;
+        RootObject& operator=(const RootObject&) noexcept = default;
+        RootObject& operator=(RootObject&&) noexcept = default;
 
         inline Object& get() noexcept;
         inline const Object& get() const noexcept;
@@ -178,7 +231,7 @@ namespace sm{
         inline operator const Object&() const noexcept;
         inline operator Object&() noexcept;
 
-        ~RootObject() noexcept;
+        ~RootObject() noexcept = default;
     };
 
     struct Box {
@@ -191,6 +244,9 @@ namespace sm{
         ObjectDict_t objects;
         ClassVec_t bases;
         unsigned boxName = 0, name = 0;
+        // fields of the last instance grown, to reserve them at once.
+        std::atomic_uint fieldsHint {0};
+        unsigned gcMark = 0; // GarbageCollector::epoch when it was marked
     };
 
     struct Enum {
@@ -225,6 +281,9 @@ namespace sm{
         Object self;
         Object* func_ptr;
         std::atomic_uint rcount;
+        unsigned gcMark = 0; // GarbageCollector::epoch when it was marked
+        unsigned gcRefs = 0; // references from instances (in GarbageCollector::countRefs())
+        bool gcCounted = false; // by GarbageCollector::countRefs(), till it returns
 
         Method() : rcount(1){}
     };
@@ -235,6 +294,128 @@ namespace sm{
 
         template <class... Tp>
         RCString(Tp&&... args) : str(std::forward<Tp>(args)...), rcount(1){}
+
+        // str.hash() and str.uSize(), computed once: after changing str, call changed().
+        size_t hash() const noexcept{
+            size_t value = _hash.load(std::memory_order_relaxed);
+            if(!value){
+                value = str.hash();
+                _hash.store(value, std::memory_order_relaxed);
+            }
+            return value;
+        }
+
+        size_t uSize() const noexcept{
+            size_t value = _uSize.load(std::memory_order_relaxed);
+            if(!value){
+                value = str.uSize() + 1;
+                _uSize.store(value, std::memory_order_relaxed);
+            }
+            return value - 1;
+        }
+
+        void changed() noexcept{
+            _hash.store(0, std::memory_order_relaxed);
+            _uSize.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        // 0 if not computed yet (if the hash is 0, it's computed each time).
+        mutable std::atomic<size_t> _hash {0};
+        mutable std::atomic<size_t> _uSize {0}; // plus one
+    };
+
+    /*
+     * Hidden class: the instances which got the same fields
+     * in the same order share the same Shape, that gives the
+     * index of each field in Instance::fields.
+     */
+    struct Shape {
+        Dict_t<unsigned> slots; // field's name -> index
+        Dict_t<Shape*> transitions; // the shapes with one more field
+        std::mutex transitions_m;
+
+        Shape() = default;
+        Shape(const Shape&) = delete;
+        Shape& operator=(const Shape&) = delete;
+
+        // returns the shape with the fields of this one plus 'id'.
+        Shape* add(unsigned id) noexcept;
+
+        ~Shape();
+    };
+
+    /*
+     * Instance::fields: unlike a vector, adding a field never moves the
+     * others, since references to them are kept on the stacks while
+     * running code which can add more (like a 'new' setting the native data).
+     * The first block is sized by reserve() (with Class::fieldsHint),
+     * so it's usually the only one; the next ones hold 'blockSize' fields each.
+     */
+    class FieldVec_t {
+    private:
+        static constexpr size_t blockSize = 8;
+
+        std::unique_ptr<Object[]> _first;
+        std::vector<std::unique_ptr<Object[]>> _blocks; // after _first
+        size_t _firstSize = 0; // capacity of _first
+        size_t _size = 0;
+
+    public:
+        class const_iterator {
+        private:
+            const FieldVec_t* _vec;
+            size_t _idx;
+        public:
+            const_iterator(const FieldVec_t* vec, size_t idx) : _vec(vec), _idx(idx) {}
+            const Object& operator*() const noexcept{ return (*_vec)[_idx]; }
+            const_iterator& operator++() noexcept{ ++_idx; return *this; }
+            bool operator!=(const const_iterator& rhs) const noexcept{ return _idx != rhs._idx; }
+        };
+
+        FieldVec_t() = default;
+        FieldVec_t(FieldVec_t&&) = default;
+        FieldVec_t& operator=(FieldVec_t&&) = default;
+
+        // only before the first field is added.
+        void reserve(size_t n){
+            if(!_size && n > _firstSize){
+                _first.reset(new Object[n]);
+                _firstSize = n;
+            }
+        }
+
+        Object& operator[](size_t idx) noexcept{
+            if(idx < _firstSize)
+                return _first[idx];
+            idx -= _firstSize;
+            return _blocks[idx / blockSize][idx % blockSize];
+        }
+
+        const Object& operator[](size_t idx) const noexcept{
+            return const_cast<FieldVec_t&>(*this)[idx];
+        }
+
+        Object& emplace_back(){
+            size_t idx = _size;
+            if(idx >= _firstSize && !((idx - _firstSize) % blockSize))
+                _blocks.emplace_back(new Object[blockSize]);
+            ++_size;
+            return (*this)[idx];
+        }
+
+        // the fields are destroyed after the vector is empty, since they can run any code.
+        void clear() noexcept{
+            std::unique_ptr<Object[]> first = std::move(_first);
+            std::vector<std::unique_ptr<Object[]>> blocks = std::move(_blocks);
+            _blocks.clear();
+            _firstSize = _size = 0;
+        }
+
+        size_t size() const noexcept{ return _size; }
+        bool empty() const noexcept{ return !_size; }
+        const_iterator begin() const noexcept{ return const_iterator(this, 0); }
+        const_iterator end() const noexcept{ return const_iterator(this, _size); }
     };
 
     class Instance {
@@ -243,17 +424,28 @@ namespace sm{
     private:
         bool deleting = false; // if dtor has been called
         bool callDelete = true; // whether destroy() has to be called
+        bool swept = false; // destroyed by a collection while a thread was releasing it
     public:
-        ObjectDict_t objects;
-        InstanceList_t::iterator it;
+        Shape* shape;
+        FieldVec_t fields; // indexed by shape->slots
+        Instance* gcPrev = nullptr, * gcNext = nullptr; // in Region::instances or nursery
+        runtime::Region* region = nullptr; // where it was made
         runtime::Runtime_t& rt;
         Class* base;
 
-        std::atomic_uint rcount, roots;
-        bool temporary;
+        std::atomic_uint rcount;
+        unsigned gcMark = 0; // GarbageCollector::epoch when it was marked
+        unsigned gcRefs = 0; // references from instances (in GarbageCollector::countRefs() and countYoungRefs())
+        bool temporary; // if it's young (in Region::nursery)
+
+        Instance(runtime::Runtime_t& _rt, Class* _base, bool temp);
 
-        Instance(runtime::Runtime_t& _rt, Class* _base, bool temp)
-            : rt(_rt), base(_base), rcount(1), roots(0), temporary(temp) {}
+        // returns nullptr if there isn't a field named 'id'.
+        inline Object* field(unsigned id) noexcept;
+        // 'id' must not be a field yet.
+        Object& addField(unsigned id) noexcept;
+        // returns the field named 'id', adding it if it doesn't exist.
+        inline Object& fieldRef(unsigned id) noexcept;
 
         Instance(Instance&& rhs) = default;
         Instance& operator=(Instance&& rhs) = default;
@@ -287,6 +479,11 @@ namespace sm{
     Object makeFunction(Function*) noexcept;
     RootObject makeList(exec::Interpreter& intp, RootObjectVec_t vec = RootObjectVec_t()) noexcept;
     RootObject makeTuple(exec::Interpreter& intp, RootObjectVec_t vec = RootObjectVec_t()) noexcept;
+    RootObject makeTable(exec::Interpreter& intp,
+        const std::vector<std::pair<RootObject, RootObject>>& entries = {}) noexcept;
+    // strings of one byte or ASCII character: made once and shared.
+    Object makeByteString(unsigned char ch) noexcept;
+    Object makeCharString(unicode_t ch) noexcept; // shared only if ASCII
 
     inline Object makeFloat(float_t value) noexcept;
     template <typename... Tp>
@@ -315,7 +512,12 @@ namespace sm{
     }
 
     void Object::refSet(Object obj) const noexcept{
-        *o_ptr = std::move(obj);
+        if(rootRef){
+            // through the RootObject it belongs to.
+            *reinterpret_cast<RootObject*>(o_ptr) = std::move(obj);
+        } else {
+            *o_ptr = std::move(obj);
+        }
     }
 
     inline Object makeInteger(integer_t value) noexcept{
@@ -397,6 +599,7 @@ namespace sm{
     inline Object makeRef<false>(RootObject& ref) noexcept{
         Object obj(ObjectType::WEAK_REFERENCE);
         obj.o_ptr = &ref.get();
+        obj.rootRef = true;
         return obj;
     }
 
@@ -404,9 +607,20 @@ namespace sm{
     inline Object makeRef<true>(RootObject& ref) noexcept{
         Object obj(ObjectType::STRONG_REFERENCE);
         obj.o_ptr = &ref.get();
+        obj.rootRef = true;
         return obj;
     }
 
+    inline Object* Instance::field(unsigned id) noexcept{
+        Dict_t<unsigned>::const_iterator it = shape->slots.find(id);
+        return it == shape->slots.end() ? nullptr : &fields[it->second];
+    }
+
+    inline Object& Instance::fieldRef(unsigned id) noexcept{
+        Object* ptr = field(id);
+        return ptr ? *ptr : addField(id);
+    }
+
     inline Object& RootObject::get() noexcept{
         return obj;
     }
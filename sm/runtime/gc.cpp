@@ -22,6 +22,7 @@
 #include <mutex>
 #include <vector>
 #include <algorithm>
+#include <climits>
 
 #include "sm/runtime/id.h"
 #include "sm/runtime/gc.h"
@@ -39,40 +40,54 @@
 namespace sm{
     using namespace ObjectType;
 
+    namespace {
+        // the write barrier of incremental marking.
+        inline void writeBarrier(const Object& obj) noexcept{
+            if(obj.type == CLASS_INSTANCE || obj.type == CLASS || obj.type == METHOD){
+                runtime::GarbageCollector* gc = runtime::GarbageCollector::marking.load(std::memory_order_relaxed);
+                if(gc)
+                    gc->shade(obj);
+            }
+        }
+    }
+
     Object::Object() noexcept
             : i(0), type(NONE) {}
 
     Object::Object(const Object& rhs) noexcept
-            : i(rhs.i), type(rhs.type) {
+            : i(rhs.i), type(rhs.type), rootRef(rhs.rootRef) {
         if(i_ptr){
             if(type == CLASS_INSTANCE){
-                ++i_ptr->rcount;
+                runtime::refInc(i_ptr->rcount);
             } else if(type == STRING){
-                ++s_ptr->rcount;
+                runtime::refInc(s_ptr->rcount);
             } else if(type == METHOD){
-                ++m_ptr->rcount;
+                runtime::refInc(m_ptr->rcount);
             }
+            writeBarrier(*this);
         }
     }
 
     Object::Object(Object&& rhs) noexcept
-            : i(rhs.i), type(rhs.type) {
+            : i(rhs.i), type(rhs.type), rootRef(rhs.rootRef) {
         rhs.type = NONE;
         rhs.i = 0;
+        if(i_ptr)
+            writeBarrier(*this);
     }
 
     Object& Object::operator=(const Object& rhs) noexcept{
         if(i_ptr){
             if(type == CLASS_INSTANCE){
-                if(!--i_ptr->rcount){
+                if(!runtime::refDec(i_ptr->rcount)){
                     i_ptr->free();
                 }
             } else if(type == STRING){
-                if(!--s_ptr->rcount){
+                if(!runtime::refDec(s_ptr->rcount)){
                     delete s_ptr;
                 }
             } else if(type == METHOD){
-                if(!--m_ptr->rcount){
+                if(!runtime::refDec(m_ptr->rcount)){
                     delete m_ptr;
                 }
             }
@@ -80,15 +95,17 @@ namespace sm{
 
         i = rhs.i;
         type = rhs.type;
+        rootRef = rhs.rootRef;
 
         if(i_ptr){
             if(type == CLASS_INSTANCE){
-                ++i_ptr->rcount;
+                runtime::refInc(i_ptr->rcount);
             } else if(type == STRING){
-                ++s_ptr->rcount;
+                runtime::refInc(s_ptr->rcount);
             } else if(type == METHOD){
-                ++m_ptr->rcount;
+                runtime::refInc(m_ptr->rcount);
             }
+            writeBarrier(*this);
         }
 
         return *this;
@@ -97,15 +114,15 @@ namespace sm{
     Object& Object::operator=(Object&& rhs) noexcept{
         if(i_ptr){
             if(type == CLASS_INSTANCE){
-                if(!--i_ptr->rcount){
+                if(!runtime::refDec(i_ptr->rcount)){
                     i_ptr->free();
                 }
             } else if(type == STRING){
-                if(!--s_ptr->rcount){
+                if(!runtime::refDec(s_ptr->rcount)){
                     delete s_ptr;
                 }
             } else if(type == METHOD){
-                if(!--m_ptr->rcount){
+                if(!runtime::refDec(m_ptr->rcount)){
                     delete m_ptr;
                 }
             }
@@ -113,25 +130,28 @@ namespace sm{
 
         i = rhs.i;
         type = rhs.type;
+        rootRef = rhs.rootRef;
 
         rhs.i = 0;
         rhs.type = NONE;
 
+        if(i_ptr)
+            writeBarrier(*this);
         return *this;
     }
 
     Object& Object::operator=(std::nullptr_t) noexcept{
         if(i_ptr){
             if(type == CLASS_INSTANCE){
-                if(!--i_ptr->rcount){
+                if(!runtime::refDec(i_ptr->rcount)){
                     i_ptr->free();
                 }
             } else if(type == STRING){
-                if(!--s_ptr->rcount){
+                if(!runtime::refDec(s_ptr->rcount)){
                     delete s_ptr;
                 }
             } else if(type == METHOD){
-                if(!--m_ptr->rcount){
+                if(!runtime::refDec(m_ptr->rcount)){
                     delete m_ptr;
                 }
             }
@@ -139,6 +159,7 @@ namespace sm{
 
         i = 0;
         type = NONE;
+        rootRef = false;
 
         return *this;
     }
@@ -154,84 +175,21 @@ namespace sm{
     Object::~Object(){
         if(i_ptr){
             if(type == CLASS_INSTANCE){
-                if(!--i_ptr->rcount){
+                if(!runtime::refDec(i_ptr->rcount)){
                     i_ptr->free();
                 }
             } else if(type == STRING){
-                if(!--s_ptr->rcount){
+                if(!runtime::refDec(s_ptr->rcount)){
                     delete s_ptr;
                 }
             } else if(type == METHOD){
-                if(!--m_ptr->rcount){
+                if(!runtime::refDec(m_ptr->rcount)){
                     delete m_ptr;
                 }
             }
         }
     }
 
-    RootObject::RootObject(const Object& rhs) noexcept{
-        if(rhs.type == ObjectType::CLASS_INSTANCE && rhs.i_ptr)
-            ++rhs.i_ptr->roots;
-        obj = rhs;
-    }
-
-    RootObject::RootObject(Object&& rhs) noexcept{
-        if(rhs.type == ObjectType::CLASS_INSTANCE && rhs.i_ptr)
-            ++rhs.i_ptr->roots;
-        obj = std::move(rhs);
-    }
-
-    RootObject::RootObject(const RootObject& rhs) noexcept{
-        obj = rhs.obj;
-        if(obj.type == ObjectType::CLASS_INSTANCE && obj.i_ptr)
-            ++obj.i_ptr->roots;
-    }
-
-    RootObject::RootObject(RootObject&& rhs) noexcept{
-        obj = rhs.obj;
-        rhs.obj = nullptr;
-    }
-
-    RootObject& RootObject::operator=(const Object& rhs) noexcept{
-        if(obj.type == ObjectType::CLASS_INSTANCE && obj.i_ptr)
-            --obj.i_ptr->roots;
-        obj = rhs;
-        if(obj.type == ObjectType::CLASS_INSTANCE && obj.i_ptr)
-            ++obj.i_ptr->roots;
-        return *this;
-    }
-
-    RootObject& RootObject::operator=(Object&& rhs) noexcept{
-        if(obj.type == ObjectType::CLASS_INSTANCE && obj.i_ptr)
-            --obj.i_ptr->roots;
-        obj = std::move(rhs);
-        if(obj.type == ObjectType::CLASS_INSTANCE && obj.i_ptr)
-            ++obj.i_ptr->roots;
-        return *this;
-    }
-
-    RootObject& RootObject::operator=(const RootObject& rhs) noexcept{
-        if(obj.type == ObjectType::CLASS_INSTANCE && obj.i_ptr)
-            --obj.i_ptr->roots;
-        obj = rhs.obj;
-        if(obj.type == ObjectType::CLASS_INSTANCE && obj.i_ptr)
-            ++obj.i_ptr->roots;
-        return *this;
-    }
-
-    RootObject& RootObject::operator=(RootObject&& rhs) noexcept {
-        if(obj.type == ObjectType::CLASS_INSTANCE && obj.i_ptr)
-            --obj.i_ptr->roots;
-        obj = std::move(rhs.obj);
-        rhs.obj = nullptr;
-        return *this;
-    }
-
-    RootObject::~RootObject() noexcept{
-        if(obj.type == ObjectType::CLASS_INSTANCE && obj.i_ptr)
-            --obj.i_ptr->roots;
-    }
-
     ObjectHash::ObjectHash(runtime::Runtime_t& ref) : rt(ref){}
 
     size_t ObjectHash::operator() (const RootObject& hashable) const noexcept{
@@ -243,7 +201,7 @@ namespace sm{
             case FLOAT:
                 return std::hash<float_t>()(hashable->f);
             case STRING:
-                return hashable->s_ptr->str.hash();
+                return hashable->s_ptr->hash();
             case CLASS_INSTANCE: {
                 exec::Interpreter* intp = rt.getCurrentThread();
                 if(!intp)
@@ -414,25 +372,78 @@ namespace sm{
 
 
     RootObject newInstance(exec::Interpreter& intp, Class* base, const RootObjectVec_t& args) noexcept {
-        RootObject self, clazz(ObjectType::CLASS);
+        Object cls(ObjectType::CLASS);
+        cls.c_ptr = base;
+        RootObject self, clazz(std::move(cls));
         Function* func_ptr;
-        clazz->c_ptr = base;
 
         runtime::callable(clazz, self, func_ptr);
         return intp.callFunction(func_ptr, args, self, true);
     }
 
+    Shape* Shape::add(unsigned id) noexcept{
+        std::lock_guard<std::mutex> lock(transitions_m);
+        Shape*& next = transitions[id];
+        if(!next){
+            next = new Shape;
+            next->slots = slots;
+            next->slots.emplace(id, slots.size());
+        }
+        return next;
+    }
+
+    Shape::~Shape(){
+        for(auto& transition : transitions)
+            delete transition.second;
+    }
+
+    Instance::Instance(runtime::Runtime_t& _rt, Class* _base, bool temp)
+            : shape(&_rt.emptyShape), rt(_rt), base(_base), rcount(1), temporary(temp) {
+        if(base)
+            fields.reserve(base->fieldsHint.load(std::memory_order_relaxed));
+    }
+
+    Object& Instance::addField(unsigned id) noexcept{
+        shape = shape->add(id);
+        Object& ref = fields.emplace_back();
+
+        if(base && fields.size() > base->fieldsHint.load(std::memory_order_relaxed))
+            base->fieldsHint.store(fields.size(), std::memory_order_relaxed);
+        return ref;
+    }
+
     void Instance::free(bool isGc) noexcept {
-        bool cantWork = !isGc && rt.gc.gcWorking;
-        if(deleting || cantWork)
+        runtime::Region& r = *region;
+        if(deleting){
+            if(swept){
+                std::lock_guard<std::mutex> lock(r.m);
+                r.remove(this);
+            }
+            return;
+        }
+        if(!isGc && rt.gc.gcWorking && rt.gc.worker == std::this_thread::get_id()){
+            // released by the collector (which locks all the regions), after its work.
+            r.deferred.emplace_back(this);
             return;
+        }
         if(isGc){
             destroy(false);
-            rt.gc.instances.erase(it);
+            r.remove(this);
         } else {
+            {
+                std::lock_guard<std::mutex> lock(r.m);
+                if(deleting)
+                    return;
+                if(rt.gc.cycle){
+                    // it could be gray, so the cycle releases it when it finishes.
+                    r.deferred.emplace_back(this);
+                    return;
+                }
+                deleting = true; // collections of other threads leave it alone
+            }
             destroy(callDelete);
-            std::lock_guard<std::mutex> lock(rt.gc.instances_m);
-            rt.gc.instances.erase(it);
+            std::lock_guard<std::mutex> lock(r.m);
+            r.remove(this);
         }
     }
 
@@ -450,6 +461,7 @@ namespace sm{
 
         Object self = Object(ObjectType::CLASS_INSTANCE);
         self.i_ptr = this;
+        runtime::refInc(rcount); // self is released by its destructor
         deleting = true;
 
         if(invokeDeleteFn){
@@ -474,7 +486,8 @@ namespace sm{
             }
         }
 
-        objects.clear();
+        shape = &rt.emptyShape;
+        fields.clear();
     }
 
     Instance::~Instance(){
@@ -483,6 +496,9 @@ namespace sm{
 
     namespace runtime{
         std::chrono::steady_clock::time_point* Runtime_t::execStart = nullptr;
+        exec::OpProfile_t* Runtime_t::opProfile = nullptr;
+        exec::StackSampler* Runtime_t::sampler = nullptr;
+        GarbageCollector* Runtime_t::gcStats = nullptr;
         std::vector<LibHandle_t> Runtime_t::sharedLibs;
 
         // Instance Pointer's Vector  -> IPVec_t
@@ -490,126 +506,652 @@ namespace sm{
         using CPVec_t = std::vector<Class*>;
         using MPVec_t = std::vector<Method*>;
 
+        std::atomic<bool> threaded(false);
+        std::atomic<GarbageCollector*> GarbageCollector::marking(nullptr);
+
+        /*
+         * instances_m, then all the regions in order.
+         * If 'pause', the time until unlock() is counted in
+         * the collector's pauses (see GCStats).
+         */
+        class GarbageCollector::Lock {
+        private:
+            GarbageCollector& gc;
+            std::unique_lock<std::mutex> lock;
+            bool pause;
+            std::chrono::steady_clock::time_point start;
+        public:
+            explicit Lock(GarbageCollector& _gc, bool _pause = true) : gc(_gc), lock(_gc.instances_m), pause(_pause) {
+                for(std::unique_ptr<Region>& region : gc.regions)
+                    region->m.lock();
+                if(pause)
+                    start = std::chrono::steady_clock::now();
+            }
+
+            void unlock() noexcept{
+                if(pause){
+                    unsigned long long micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start).count();
+                    gc.counters.pauseTotal += micros;
+                    gc.counters.pauseMax = std::max(gc.counters.pauseMax, micros);
+                }
+                for(std::unique_ptr<Region>& region : gc.regions)
+                    region->m.unlock();
+                lock.unlock();
+            }
+
+            ~Lock(){
+                if(lock.owns_lock())
+                    unlock();
+            }
+        };
+
         Object GarbageCollector::makeTempInstance(exec::Interpreter& _intp, Class* _base) noexcept {
-            if(++allocs == threshold){
-                allocs = 0;
-                collect();
+            if(++allocs >= static_cast<int>(threshold) && !cycle){
+                if(budget)
+                    step();
+                else
+                    collect();
+            } else if(cycle){
+                if(++cycleAllocs >= garbageCollectorStep)
+                    step();
+            } else if(_intp.region->nursery.size() >= nurserySize
+                    && !runtime::threaded.load(std::memory_order_relaxed)){
+                minorCollect();
             }
 
-            instances.emplace_back(*_intp.rt, _base, true);
-            InstanceList_t::iterator it = std::prev(instances.end());
-            it->it = it; // this line made my day :D
-            it->temporary = true;
+            Region& region = *_intp.region;
+            std::lock_guard<std::mutex> lock(region.m);
+            Instance* ptr = region.slabs.make(*_intp.rt, _base, true);
+            ptr->region = &region;
+            region.nursery.push_back(ptr);
+            ++region.made;
+            if(cycle)
+                ptr->gcMark = epoch; // made BLACK, it can't be marked anymore
 
             Object obj;
             obj.type = ObjectType::CLASS_INSTANCE;
-            obj.i_ptr = &*it;
+            obj.i_ptr = ptr;
             return obj;
         }
 
+        Region* GarbageCollector::takeRegion(){
+            std::lock_guard<std::mutex> lock(instances_m);
+            for(std::unique_ptr<Region>& region : regions){
+                bool owned = false;
+                if(region->owned.compare_exchange_strong(owned, true))
+                    return region.get();
+            }
+
+            regions.emplace_back(new Region);
+            regions.back()->owned = true;
+            return regions.back().get();
+        }
+
+        void GarbageCollector::giveRegion(Region* region) noexcept{
+            region->owned = false;
+        }
+
+        // the gray objects: marked, but their children aren't yet.
         struct GCData{
-            exec::Interpreter intp;
-            IPVec_t white, gray;
+            unsigned epoch;
+            IPVec_t gray;
             CPVec_t classes;
             MPVec_t methods;
 
-            GCData(Runtime_t& rt) noexcept : intp(rt) {}
+            bool empty() const noexcept{
+                return gray.empty() && classes.empty() && methods.empty();
+            }
+        };
+
+        // an incremental collection, see GarbageCollector::begin().
+        struct GCCycle{
+            GCData data;
+            GCData shaded; // by the write barrier (GarbageCollector::shaded_m)
         };
 
-        void whiteToGray(GCData& data, Object& obj){
-            if(obj.type == ObjectType::CLASS_INSTANCE){
-                Instance* ptr = obj.i_ptr;
-                IPVec_t::iterator curr = std::find(data.white.begin(), data.white.end(), ptr);
+        // calls fn for each object pointed by the fields of ptr or natively linked to it.
+        template <typename Fn>
+        void forEachChild(Instance* ptr, Fn fn){
+            for(const Object& child : ptr->fields)
+                fn(child);
+
+            if(!ptr->base)
+                return;
+
+            ObjectDict_t::iterator it = ptr->base->objects.find(runtime::gcSearchId);
+            if(it != ptr->base->objects.end()){
+                Object self(ObjectType::CLASS_INSTANCE);
+                self.i_ptr = ptr;
+                runtime::refInc(ptr->rcount); // self is released by its destructor
 
                 /*
-                 * If curr is in WHITE, it's neither in the GRAY nor in the BLACK
+                 * all objects natively linked
+                 * to ptr, such as for List or Tuple.
                 */
-                if(curr != data.white.end()) {
-                    // moving curr (WHITE) in GRAY
-                    std::swap(*curr, data.white.back());
-                    data.white.pop_back();
-                    data.gray.emplace_back(ptr);
-
-                    for(auto& child : ptr->objects){
-                        // recursively search inside all objects pointed by obj
-                        whiteToGray(data, child.second);
+                ObjectVec_t out;
+                it->second.gcs_ptr(self, out);
+                for(const Object& child : out)
+                    fn(child);
+            }
+        }
+
+        void whiteToGray(GCData& data, const Object& obj){
+            switch(obj.type){
+                case ObjectType::CLASS_INSTANCE:
+                    if(obj.i_ptr->gcMark != data.epoch){
+                        obj.i_ptr->gcMark = data.epoch;
+                        data.gray.emplace_back(obj.i_ptr);
                     }
+                    break;
+
+                case ObjectType::CLASS:
+                    if(obj.c_ptr->gcMark != data.epoch){
+                        obj.c_ptr->gcMark = data.epoch;
+                        data.classes.emplace_back(obj.c_ptr);
+                    }
+                    break;
+
+                case ObjectType::METHOD:
+                    if(obj.m_ptr->gcMark != data.epoch){
+                        obj.m_ptr->gcMark = data.epoch;
+                        data.methods.emplace_back(obj.m_ptr);
+                    }
+                    break;
+            }
+        }
+
+        void grayToBlack(GCData& data, Instance* ptr){
+            forEachChild(ptr, [&data](const Object& child){
+                whiteToGray(data, child);
+            });
+
+            // static objects of its class
+            if(ptr->base && ptr->base->gcMark != data.epoch){
+                ptr->base->gcMark = data.epoch;
+                data.classes.emplace_back(ptr->base);
+            }
+        }
+
+        unsigned GarbageCollector::nextEpoch() noexcept{
+            if(++epoch == 0){
+                // instances never marked have 0.
+                for(std::unique_ptr<Region>& region : regions){
+                    for(Instance& inst : region->instances)
+                        inst.gcMark = 0;
+                    for(Instance& inst : region->nursery)
+                        inst.gcMark = 0;
                 }
+                epoch = 1;
+            }
+            return epoch;
+        }
 
-                ObjectDict_t::iterator it = obj.i_ptr->base->objects.find(runtime::gcSearchId);
-                if(it != obj.i_ptr->base->objects.end()){
-                    ObjectVec_t out;
-                    it->second.gcs_ptr(obj, out);
+        void GarbageCollector::sweep(InstanceList_t& list, unsigned mark){
+            // now WHITE contains garbage.
+            IPVec_t white;
+            for(Instance& inst : list){
+                // without references, the thread which released it frees it.
+                if(inst.gcMark != mark && inst.rcount && !inst.deleting)
+                    white.emplace_back(&inst);
+            }
+
+            /*
+             * the objects of all the garbage are released before
+             * deleting any of it, since they can point to each other.
+             */
+            for(Instance* ptr : white)
+                ptr->deleting = true;
+            for(Instance* ptr : white)
+                ptr->destroy(false);
+            for(Instance* ptr : white){
+                /*
+                 * else it's still pointed (e.g. by a thread which is
+                 * releasing it), it's deleted when it's released.
+                 */
+                if(!ptr->rcount)
+                    ptr->region->remove(ptr);
+                else
+                    ptr->swept = true;
+            }
+        }
+
+        void GarbageCollector::countYoungRefs() noexcept{
+            for(std::unique_ptr<Region>& region : regions){
+                for(Instance& inst : region->nursery)
+                    inst.gcRefs = 0;
+            }
+
+            for(std::unique_ptr<Region>& region : regions){
+                for(Instance& inst : region->nursery){
+                    if(inst.deleting)
+                        continue;
+                    forEachChild(&inst, [](const Object& child){
+                        if(child.type == ObjectType::CLASS_INSTANCE && child.i_ptr->temporary)
+                            ++child.i_ptr->gcRefs;
+                    });
+                }
+            }
+        }
+
+        /*
+         * Instance::gcRefs (and Method::gcRefs) = references from the
+         * instances, also through their methods (Method::self). The
+         * other ones come from the stacks, RootObjects, boxes and classes:
+         * instances with more references (rcount) than these are roots.
+         * 'methods' are the ones pointed by instances.
+         */
+        void GarbageCollector::countRefs(std::vector<Method*>& methods) noexcept{
+            for(std::unique_ptr<Region>& region : regions){
+                for(InstanceList_t* list : {&region->instances, &region->nursery}){
+                    for(Instance& inst : *list)
+                        inst.gcRefs = 0;
+                }
+            }
 
-                    for(auto& child : out){
-                        /*
-                         * recursively search inside all objects
-                         * natively linked to obj, such as for
-                         * List or Tuple.
-                        */
-                        whiteToGray(data, child);
+            methods.clear();
+            for(std::unique_ptr<Region>& region : regions){
+                for(InstanceList_t* list : {&region->instances, &region->nursery}){
+                    for(Instance& inst : *list){
+                        if(inst.deleting)
+                            continue;
+                        forEachChild(&inst, [&methods](const Object& child){
+                            if(child.type == ObjectType::CLASS_INSTANCE){
+                                ++child.i_ptr->gcRefs;
+                            } else if(child.type == ObjectType::METHOD){
+                                Method* ptr = child.m_ptr;
+                                if(!ptr->gcCounted){
+                                    ptr->gcCounted = true;
+                                    ptr->gcRefs = 0;
+                                    methods.emplace_back(ptr);
+                                    if(ptr->self.type == ObjectType::CLASS_INSTANCE)
+                                        ++ptr->self.i_ptr->gcRefs;
+                                }
+                                ++ptr->gcRefs;
+                            }
+                        });
                     }
                 }
+            }
 
-            } else if(obj.type == ObjectType::CLASS){
-                if(std::find(data.classes.begin(), data.classes.end(), obj.c_ptr) == data.classes.end())
-                    return;
+            for(Method* ptr : methods)
+                ptr->gcCounted = false;
+        }
 
-                data.classes.emplace_back(obj.c_ptr);
-                for(auto& child : obj.c_ptr->objects)
-                    whiteToGray(data, child.second);
-            } else if(obj.type == ObjectType::METHOD){
-                if(std::find(data.methods.begin(), data.methods.end(), obj.m_ptr) == data.methods.end())
-                    return;
+        // grays the roots found by countRefs().
+        void GarbageCollector::grayRoots(GCData& data, const std::vector<Method*>& methods){
+            for(std::unique_ptr<Region>& region : regions){
+                for(InstanceList_t* list : {&region->instances, &region->nursery}){
+                    for(Instance& inst : *list){
+                        if(inst.rcount > inst.gcRefs && inst.gcMark != data.epoch && !inst.deleting){
+                            inst.gcMark = data.epoch;
+                            data.gray.emplace_back(&inst);
+                        }
+                    }
+                }
+            }
 
-                data.methods.emplace_back(obj.m_ptr);
-                whiteToGray(data, obj.m_ptr->self);
+            for(Method* ptr : methods){
+                if(ptr->rcount > ptr->gcRefs && ptr->gcMark != data.epoch){
+                    ptr->gcMark = data.epoch;
+                    data.methods.emplace_back(ptr);
+                }
+            }
+        }
+
+        // the young instances left become old.
+        void GarbageCollector::promote() noexcept{
+            for(std::unique_ptr<Region>& region : regions){
+                for(Instance& inst : region->nursery)
+                    inst.temporary = false;
+                region->instances.splice(region->nursery);
             }
         }
 
         /*
          * Tri-color garbage collection.
-         * 3rd implementation (2017.09.17)
+         * 5th implementation
+         *
+         * An object is BLACK or GRAY if its gcMark is the epoch
+         * of this collection (GRAY ones are still in the stacks
+         * of GCData), WHITE otherwise. So no object is ever
+         * searched and nothing is reset between collections.
+         *
+         * Roots aren't counted by the stacks and the RootObjects:
+         * they're the instances with more references than the
+         * ones from other instances (countRefs()), as for the
+         * young ones in minorCollect().
          *
-         * Note: There is no BLACK, because we
-         * can easily avoid to use it.
+         * The marking is incremental: begin() grays the roots,
+         * then each step() (every garbageCollectorStep new
+         * instances) marks for at most 'budget' microseconds,
+         * while all the threads go on. So that no BLACK object
+         * points to a WHITE one, the objects copied or moved in
+         * the meantime are grayed by shade(), the new instances
+         * are BLACK and the ones released are kept until the
+         * end (they could be in the stacks). The last step
+         * grays the roots made in the meantime, then sweeps:
+         * this one isn't bounded.
          *
         */
 
-        void GarbageCollector::collect(){
-            std::lock_guard<std::mutex> lock1(instances_m), lock2(_rt->threads_m);
-            GCData data(*_rt);
+        // with the collector's Lock.
+        void GarbageCollector::begin(){
+            GCCycle* c = new GCCycle;
+            cycleAllocs = 0;
+            c->data.epoch = c->shaded.epoch = nextEpoch();
+            cycle = c;
+            // before counting, since other threads can move their references meanwhile.
+            marking = this;
+
+            // GRAY = roots
+            MPVec_t methods;
+            countRefs(methods);
+            grayRoots(c->data, methods);
+        }
+
+        // returns false if 'micros' (if not 0) have elapsed before the end.
+        bool GarbageCollector::mark(GCCycle& c, unsigned micros){
+            GCData& data = c.data;
+            std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now()
+                + std::chrono::microseconds(micros);
+            unsigned n = 0;
+
+            while(true){
+                if(data.empty()){
+                    std::lock_guard<std::mutex> lock(shaded_m);
+                    if(c.shaded.empty())
+                        return true;
+                    std::swap(data.gray, c.shaded.gray);
+                    std::swap(data.classes, c.shaded.classes);
+                    std::swap(data.methods, c.shaded.methods);
+                }
+
+                if(!data.gray.empty()){
+                    Instance* ptr = data.gray.back();
+                    data.gray.pop_back();
+                    grayToBlack(data, ptr);
+                } else if(!data.classes.empty()){
+                    Class* ptr = data.classes.back();
+                    data.classes.pop_back();
+                    for(const auto& child : ptr->objects)
+                        whiteToGray(data, child.second);
+                } else {
+                    Method* ptr = data.methods.back();
+                    data.methods.pop_back();
+                    whiteToGray(data, ptr->self);
+                }
+
+                if(micros && !(++n % 64) && std::chrono::steady_clock::now() >= end)
+                    return false;
+            }
+        }
+
+        // returns the instances to release (see release()).
+        std::vector<Instance*> GarbageCollector::finish(){
+            GCCycle& c = *cycle.load();
+            worker = std::this_thread::get_id();
             gcWorking = true;
 
-            /*
-             * GRAY = roots
-             * WHITE = other objects
-            */
-            for(Instance& inst : instances){
-                if(inst.roots)
-                    data.gray.emplace_back(&inst);
-                else
-                    data.white.emplace_back(&inst);
+            // GRAY = roots made during the marking
+            MPVec_t methods;
+            countRefs(methods);
+            grayRoots(c.data, methods);
+
+            for(std::unique_ptr<Region>& region : regions){
+                // the deferred ones still point to their objects until they're released.
+                for(Instance* ptr : region->deferred){
+                    if(!ptr->deleting && ptr->gcMark != epoch){
+                        ptr->gcMark = epoch;
+                        c.data.gray.emplace_back(ptr);
+                    }
+                }
             }
+            mark(c, 0);
+            marking = nullptr;
 
-            while(!data.gray.empty()){
-                Instance* ptr = data.gray.back();
-                data.gray.pop_back();
+            for(std::unique_ptr<Region>& region : regions){
+                sweep(region->nursery, epoch);
+                sweep(region->instances, epoch);
+            }
+            promote();
 
-                for(auto& child : ptr->objects){
-                    whiteToGray(data, child.second);
+            size_t alive = 0;
+            for(std::unique_ptr<Region>& region : regions)
+                alive += region->instances.size();
+
+            allocs = 0;
+            unsigned long long next = static_cast<unsigned long long>(alive) * growth / 100;
+            next = std::max<unsigned long long>(next, minThreshold);
+            threshold = static_cast<unsigned>(std::min<unsigned long long>(next, INT_MAX));
+
+            {
+                std::lock_guard<std::mutex> lock(shaded_m);
+                cycle = nullptr;
+            }
+            delete &c;
+
+            // now we've finished! good job!
+            ++counters.collections;
+            gcWorking = false;
+            return takeDeferred();
+        }
+
+        // the deferred instances still without references.
+        std::vector<Instance*> GarbageCollector::takeDeferred(){
+            IPVec_t dead;
+            for(std::unique_ptr<Region>& region : regions){
+                for(Instance* ptr : region->deferred){
+                    if(!ptr->rcount && !ptr->deleting){
+                        ptr->deleting = true; // not swept, even by the next collections
+                        dead.emplace_back(ptr);
+                    }
                 }
+                region->deferred.clear();
             }
+            return dead;
+        }
 
-            // now WHITE contains garbage.
-            for(Instance* ptr : data.white){
-                if(!ptr->roots){
-                    ptr->free(true);
+        // 'delete' can run any code, so it's called without locks.
+        void GarbageCollector::release(const std::vector<Instance*>& dead){
+            for(Instance* ptr : dead){
+                ptr->destroy(ptr->callDelete);
+                std::lock_guard<std::mutex> lock(ptr->region->m);
+                ptr->region->remove(ptr);
+            }
+        }
+
+        void GarbageCollector::step(){
+            IPVec_t dead;
+            {
+                Lock lock(*this);
+                if(!cycle)
+                    begin();
+
+                cycleAllocs = 0;
+                ++counters.steps;
+                worker = std::this_thread::get_id();
+                gcWorking = true;
+                bool done = mark(*cycle.load(), budget);
+                gcWorking = false;
+                if(!done)
+                    return;
+                dead = finish();
+            }
+            release(dead);
+        }
+
+        void GarbageCollector::collect(){
+            IPVec_t dead;
+            {
+                Lock lock(*this);
+                if(!cycle)
+                    begin();
+                dead = finish();
+            }
+            release(dead);
+        }
+
+        void GarbageCollector::shade(const Object& obj) noexcept{
+            switch(obj.type){
+                case ObjectType::CLASS_INSTANCE:
+                    if(obj.i_ptr->gcMark == epoch)
+                        return;
+                    break;
+                case ObjectType::CLASS:
+                    if(obj.c_ptr->gcMark == epoch)
+                        return;
+                    break;
+                case ObjectType::METHOD:
+                    if(obj.m_ptr->gcMark == epoch)
+                        return;
+                    break;
+                default:
+                    return;
+            }
+
+            std::lock_guard<std::mutex> lock(shaded_m);
+            GCCycle* c = cycle;
+            if(c)
+                whiteToGray(c->shaded, obj);
+        }
+
+        GCStats GarbageCollector::stats(){
+            std::map<Class*, size_t> classes;
+            GCStats s;
+            {
+                Lock lock(*this, false);
+                s = counters;
+                for(std::unique_ptr<Region>& region : regions){
+                    s.made += region->made;
+                    s.heap += region->slabs.bytes();
+                    for(InstanceList_t* list : {&region->instances, &region->nursery}){
+                        s.alive += list->size();
+                        for(Instance& inst : *list)
+                            ++classes[inst.base];
+                    }
                 }
             }
 
-            // now we've finished! good job!
+            for(const std::pair<Class* const, size_t>& pair : classes)
+                s.classes.emplace_back(_rt->className(pair.first), pair.second);
+            std::stable_sort(s.classes.begin(), s.classes.end(),
+                [](const std::pair<string_t, size_t>& lhs, const std::pair<string_t, size_t>& rhs){
+                    return lhs.second > rhs.second;
+                });
+            return s;
+        }
+
+        void GarbageCollector::printStats(std::ostream& out){
+            constexpr size_t maxClasses = 20;
+            GCStats s = stats();
+
+            std::ios::fmtflags flags = out.flags();
+            out << std::fixed << std::setprecision(3);
+            out << ".. Garbage collector: " << s.made << " instances made, "
+                << s.alive << " alive in " << s.heap / 1024 << " KiB." << std::endl;
+            out << "  collections        " << s.collections << " (" << s.steps << " steps)" << std::endl;
+            out << "  minor collections  " << s.minorCollections << std::endl;
+            out << "  pauses             " << s.pauseTotal / 1000. << " ms total, "
+                << s.pauseMax / 1000. << " ms max" << std::endl;
+
+            if(!s.classes.empty()){
+                out << "  alive instances by class:" << std::endl;
+                for(size_t i = 0; i != s.classes.size() && i != maxClasses; ++i){
+                    out << "  " << std::setw(12) << s.classes[i].second
+                        << "  " << s.classes[i].first << std::endl;
+                }
+                if(s.classes.size() > maxClasses)
+                    out << "  ... " << s.classes.size() - maxClasses << " more classes" << std::endl;
+            }
+            out.flags(flags);
+        }
+
+        GarbageCollector::~GarbageCollector(){
+            if(marking == this)
+                marking = nullptr;
+            delete cycle.load();
+
+            /*
+             * the fields first, since they can point to
+             * the instances deleted before their turn.
+             */
+            for(std::unique_ptr<Region>& region : regions){
+                for(InstanceList_t* list : {&region->instances, &region->nursery}){
+                    for(Instance& inst : *list){
+                        inst.shape = &_rt->emptyShape;
+                        inst.fields.clear();
+                    }
+                }
+            }
+            for(std::unique_ptr<Region>& region : regions){
+                for(InstanceList_t* list : {&region->instances, &region->nursery}){
+                    while(!list->empty())
+                        region->remove(&*list->begin());
+                }
+            }
+        }
+
+        /*
+         * Collection of the young instances only.
+         *
+         * Instead of a write barrier (the objects of the old
+         * instances, but also the ones of the native data, of
+         * classes and methods can point to young instances),
+         * roots are the young instances with more references
+         * (rcount) than the ones from the other young instances.
+         * That holds only while one thread runs: another one could
+         * move a reference between counting and sweeping, so once
+         * std.thread has started a thread only full collections run
+         * (the nursery is swept and promoted by them).
+         *
+        */
+
+        void GarbageCollector::minorCollect(){
+            Lock lock(*this);
+            if(cycle)
+                return; // it would change the epoch
+            if(runtime::threaded.load(std::memory_order_relaxed))
+                return; // see above
+            ++counters.minorCollections;
+            IPVec_t gray;
+            unsigned mark = nextEpoch();
+            worker = std::this_thread::get_id();
+            gcWorking = true;
+
+            countYoungRefs();
+
+            // GRAY = roots and young instances pointed from elsewhere
+            for(std::unique_ptr<Region>& region : regions){
+                for(Instance& inst : region->nursery){
+                    if(inst.rcount > inst.gcRefs && !inst.deleting){
+                        inst.gcMark = mark;
+                        gray.emplace_back(&inst);
+                    }
+                }
+            }
+
+            while(!gray.empty()){
+                Instance* ptr = gray.back();
+                gray.pop_back();
+
+                forEachChild(ptr, [&gray, mark](const Object& child){
+                    if(child.type == ObjectType::CLASS_INSTANCE && child.i_ptr->temporary
+                            && child.i_ptr->gcMark != mark){
+                        child.i_ptr->gcMark = mark;
+                        gray.emplace_back(child.i_ptr);
+                    }
+                });
+            }
+
+            for(std::unique_ptr<Region>& region : regions)
+                sweep(region->nursery, mark);
+            promote();
             gcWorking = false;
+
+            IPVec_t dead = takeDeferred();
+            lock.unlock();
+            release(dead);
         }
 
         std::thread::id Runtime_t::main_id;
@@ -631,6 +1173,24 @@ namespace sm{
             }
         }
 
+        string_t Runtime_t::className(const Class* ptr) const{
+            if(!ptr)
+                return "<none>";
+            return boxNames[ptr->boxName] + "::" + nameFromId(ptr->name);
+        }
+
+        string_t Runtime_t::location(size_t pc){
+            unsigned source, line;
+            if(!pc || !lines.find(pc -1, source, line))
+                return {};
+
+            if(source < sources.size() && sources.getSource(source))
+                return sources.getSource(source)->sourceName + ":" + std::to_string(line);
+            if(source < boxNames.size())
+                return boxNames[source] + ":" + std::to_string(line);
+            return std::string("?:") + std::to_string(line);
+        }
+
         // could be nullptr!! (checked by the caller)
         exec::Interpreter* Runtime_t::getCurrentThread() noexcept{
             std::thread::id curr = std::this_thread::get_id();
@@ -654,6 +1214,14 @@ namespace sm{
                 (static_cast<float>(std::chrono::duration_cast<std::chrono::microseconds>(execEnd - *execStart).count())
                 / 1000.f) << " ms." << std::endl;
             }
+            if(opProfile)
+                opProfile->print(std::cout);
+            if(gcStats){
+                gcStats->printStats(std::cout);
+                gcStats = nullptr;
+            }
+            if(sampler)
+                sampler->stop();
             freeLibraries();
         }
 
@@ -674,7 +1242,13 @@ namespace sm{
         }
 
         Runtime_t::~Runtime_t() {
+            if(gcStats == &gc){
+                // exit() would come too late.
+                gcStats->printStats(std::cout);
+                gcStats = nullptr;
+            }
             freeLibraries();
+            gc.worker = std::this_thread::get_id();
             gc.gcWorking = true;
             // keeping gcWorking true
         }
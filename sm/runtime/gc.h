@@ -24,10 +24,13 @@
 #include <thread>
 #include <mutex>
 #include <chrono>
-#include <list>
+#include <array>
+#include <memory>
+#include <iosfwd>
 
 #include "sm/typedefs.h"
 #include "sm/runtime/Object.h"
+#include "sm/runtime/slab.h"
 #include "sm/error/error.h"
 #include "sm/compile/v1/Compiler.h"
 
@@ -35,6 +38,8 @@ namespace sm{
     namespace exec{
         class Interpreter;
         class IntpData;
+        struct OpProfile_t;
+        class StackSampler;
 
         struct TWrapper {
             std::thread th;
@@ -46,44 +51,205 @@ namespace sm{
             IntpData* data;
         };
 
+        /*
+         * the bytes of an instruction (up to 5), followed
+         * by the id of its inline cache, if it has one.
+         * Superinstructions use all of them.
+         */
+        using InstBytes_t = std::array<uint8_t, 12>;
+
+        /*
+         * Runtime_t::code pre-decoded by Interpreter::start(): one entry
+         * for each byte of the code, so that a jump can land anywhere
+         * without re-synchronizing the stream.
+         */
+        struct ThreadedInst_t {
+            #ifdef _SM_THREADED_DISPATCH
+                const void* label = nullptr; // handler's label in Interpreter::start()
+            #endif
+            InstBytes_t inst {};
+            uint8_t size = 1;
+        };
+
+        using ThreadedCode_t = std::vector<ThreadedInst_t>;
         using ThreadVec_t = std::vector<ThreadData>;
         using ThreadMap_t = std::map<std::thread::id, ThreadData>;
     }
 
 
     namespace runtime {
+        struct GCCycle;
+        struct GCData;
+
+        /*
+         * Instances linked by Instance::gcPrev and gcNext: adding,
+         * removing and moving all of them to another list need
+         * no memory. It doesn't own them (see GarbageCollector::slabs).
+         */
+        class InstanceList_t {
+        private:
+            Instance* _first = nullptr;
+            Instance* _last = nullptr;
+            size_t _size = 0;
+
+        public:
+            class iterator {
+            private:
+                Instance* _ptr;
+            public:
+                iterator(Instance* ptr) : _ptr(ptr) {}
+                Instance& operator*() const noexcept{ return *_ptr; }
+                iterator& operator++() noexcept{ _ptr = _ptr->gcNext; return *this; }
+                bool operator!=(const iterator& rhs) const noexcept{ return _ptr != rhs._ptr; }
+            };
+
+            InstanceList_t() = default;
+            InstanceList_t(const InstanceList_t&) = delete;
+            InstanceList_t& operator=(const InstanceList_t&) = delete;
+
+            void push_back(Instance* ptr) noexcept{
+                ptr->gcPrev = _last;
+                ptr->gcNext = nullptr;
+                (_last ? _last->gcNext : _first) = ptr;
+                _last = ptr;
+                ++_size;
+            }
+
+            // 'ptr' must be in this list.
+            void erase(Instance* ptr) noexcept{
+                (ptr->gcPrev ? ptr->gcPrev->gcNext : _first) = ptr->gcNext;
+                (ptr->gcNext ? ptr->gcNext->gcPrev : _last) = ptr->gcPrev;
+                --_size;
+            }
+
+            // moves all the instances of 'other' at the end of this list.
+            void splice(InstanceList_t& other) noexcept{
+                if(!other._first)
+                    return;
+                other._first->gcPrev = _last;
+                (_last ? _last->gcNext : _first) = other._first;
+                _last = other._last;
+                _size += other._size;
+                other._first = other._last = nullptr;
+                other._size = 0;
+            }
+
+            size_t size() const noexcept{ return _size; }
+            bool empty() const noexcept{ return !_size; }
+            iterator begin() const noexcept{ return iterator(_first); }
+            iterator end() const noexcept{ return iterator(nullptr); }
+        };
+
+        /*
+         * Thread-local allocation region: each exec::Interpreter makes
+         * its instances in its own one, locking only its mutex, so the
+         * threads which make and release their own instances don't
+         * wait for each other. Collections lock all the regions and
+         * take their instances as a single heap. When its thread ends,
+         * a region is kept, with its instances, for the next one.
+         */
+        struct Region {
+            std::mutex m; // all the members but 'owned'
+            Slabs<Instance, garbageCollectorSlab> slabs; // the memory of its instances
+            InstanceList_t instances; // old instances
+            InstanceList_t nursery; // young instances (Instance::temporary), made after the last collection
+            std::vector<Instance*> deferred; // instances released during a cycle or by the collector
+            unsigned long long made = 0; // instances made in it
+            std::atomic_bool owned; // by an exec::Interpreter
+
+            Region() : owned(false) {}
+
+            // removes it from its list and deletes it.
+            void remove(Instance* ptr) noexcept{
+                (ptr->temporary ? nursery : instances).erase(ptr);
+                slabs.destroy(ptr);
+            }
+        };
+
+        // see GarbageCollector::stats().
+        struct GCStats {
+            unsigned long long made = 0; // instances made
+            unsigned long long collections = 0, minorCollections = 0;
+            unsigned long long steps = 0; // of marking, with option -b or gc_budget()
+            unsigned long long pauseTotal = 0, pauseMax = 0; // microseconds with the heap locked
+            size_t alive = 0; // instances not deleted yet
+            size_t heap = 0; // bytes of the slabs
+            std::vector<std::pair<string_t, size_t>> classes; // 'alive' by class, the most first
+        };
+
         class GarbageCollector {
             friend Runtime_t;
             friend Instance;
 
         private:
             Runtime_t* _rt;
-
-            void addTemporaryInstance(Instance* ptr);
-            void removeTemporaryInstance(Instance* ptr);
-            void addInstance(Instance* ptr);
-            void removeInstance(Instance* ptr);
-            void collect();
+            std::atomic<GCCycle*> cycle{nullptr}; // the incremental collection in progress, if any (read without locks)
+            std::mutex shaded_m; // GCCycle::shaded and deleting cycle
+            unsigned cycleAllocs = 0; // instances made since the last step
+            std::vector<std::unique_ptr<Region>> regions; // never shrinks
+            GCStats counters; // all but the ones counted by stats()
+
+            class Lock; // instances_m and all the regions
+
+            unsigned nextEpoch() noexcept;
+            void sweep(InstanceList_t& list, unsigned mark);
+            void countRefs(std::vector<Method*>& methods) noexcept;
+            void countYoungRefs() noexcept; // Instance::gcRefs from the young instances
+            void grayRoots(GCData& data, const std::vector<Method*>& methods);
+            void promote() noexcept;
+            void begin();
+            bool mark(GCCycle& c, unsigned micros);
+            std::vector<Instance*> finish();
+            std::vector<Instance*> takeDeferred();
+            void release(const std::vector<Instance*>& dead);
 
         public:
-            InstanceList_t instances;
-            std::mutex instances_m;
-            std::atomic_uint allocs;
-            unsigned threshold;
+            /*
+             * the collector whose cycle is marking, nullptr otherwise.
+             * Each copy or move of an Object checks it, to shade the
+             * pointed object (see shade()).
+             */
+            static std::atomic<GarbageCollector*> marking;
+
+            std::mutex instances_m; // collections and 'regions', always locked before any Region
+            std::atomic_int allocs; // instances made since the last collection, less the deleted ones
+            unsigned threshold; // allocs which start a collection
+            /*
+             * after each collection, threshold is 'growth'% of the
+             * instances left, but at least 'minThreshold'.
+             */
+            unsigned growth = garbageCollectorGrowth;
+            unsigned minThreshold = garbageCollectorThreshold;
+            unsigned nurserySize = garbageCollectorNursery; // young instances which start a minor collection
+            unsigned budget = garbageCollectorBudget; // microseconds of each step of marking, 0 to collect at once
+            unsigned epoch = 0; // objects with this gcMark are reachable (in collect())
             bool gcWorking;
+            std::thread::id worker; // the thread which set gcWorking, its releases are ignored
 
             GarbageCollector(Runtime_t* rt) : _rt(rt), allocs(0),
                 threshold(garbageCollectorThreshold), gcWorking(false) {};
 
+            void collect(); // at once, finishing the cycle in progress
+            void minorCollect(); // young instances only
+            void step(); // a step of the cycle in progress, which starts if there's none
+            void shade(const Object& obj) noexcept; // write barrier
+
+            GCStats stats(); // walks the whole heap
+            void printStats(std::ostream& out);
+
             Object makeTempInstance(exec::Interpreter& _intp,
                     Class* _base) noexcept;
 
+            // a region not owned by other interpreters, which becomes owned.
+            Region* takeRegion();
+            void giveRegion(Region* region) noexcept;
+
             GarbageCollector(const GarbageCollector&) = delete;
             GarbageCollector(GarbageCollector&&) = delete;
             GarbageCollector& operator=(const GarbageCollector&) = delete;
             GarbageCollector& operator=(GarbageCollector&&) = delete;
 
-            ~GarbageCollector() = default;
+            ~GarbageCollector();
         };
 
         using LibHandle_t =
@@ -98,12 +264,23 @@ namespace sm{
         class Runtime_t {
         public:
             static std::chrono::steady_clock::time_point* execStart;
+            static exec::OpProfile_t* opProfile; // not null with option -P
+            static exec::StackSampler* sampler; // not null with option -F
+            static GarbageCollector* gcStats; // not null with option -M, until it's destroyed
             static void exit() noexcept;
             GarbageCollector gc;
+            Shape emptyShape; // the shape of new instances
 
             BoxVec_t boxes;
             Sources sources;
             ByteCode_t code;
+            compile::LineTable lines; // source lines of code
+
+            // built at the first Interpreter::start(), code must not change after it.
+            exec::ThreadedCode_t threadedCode;
+            std::atomic_bool threadedReady;
+            std::mutex threadedCode_m;
+            unsigned n_caches = 0; // inline caches given by Interpreter::decode()
 
             std::mutex threads_m;
             exec::ThreadMap_t threads;
@@ -118,6 +295,12 @@ namespace sm{
             std::vector<string_t>       nameConstants;
             std::vector<string_t>       boxNames;
             std::vector<String>         stringConstants;
+            /*
+             * stringConstants made once by Interpreter::decode(), then only
+             * shared by PUSH_STRING: strings must not be changed once
+             * they could be seen by the program (only the new ones are).
+             */
+            std::vector<Object>         stringObjects;
 
             std::vector<integer_t>      intConstants;
             std::vector<float_t>        floatConstants;
@@ -132,7 +315,7 @@ namespace sm{
                     min_ss = _SM_DEFAULT_MIN_SS,
                     stack_printed_elements = _SM_DEFAULT_STACK_PRINTED_ELEMENTS;
 
-            Runtime_t() : gc(this), n_threads(0) {};
+            Runtime_t() : gc(this), threadedReady(false), n_threads(0) {};
 
             Runtime_t(const Runtime_t&) = delete;
             Runtime_t(Runtime_t&&) = default;
@@ -140,6 +323,9 @@ namespace sm{
             Runtime_t& operator=(Runtime_t&&) = default;
 
             string_t nameFromId(unsigned id) const;
+            string_t className(const Class* ptr) const; // "box::name"
+            // "source:line" of the instruction ending at 'pc', empty if unknown.
+            string_t location(size_t pc);
 
             static std::vector<LibHandle_t> sharedLibs;
             static void freeLibraries() noexcept;
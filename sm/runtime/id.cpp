@@ -52,12 +52,13 @@ namespace sm{
 
         template <>
         bool find<ObjectType::CLASS_INSTANCE>(const Object& in, Object& out, unsigned id){
-            ObjectDict_t::iterator it = in.i_ptr->objects.find(id);
-            if(it != in.i_ptr->objects.end()){
-                out = it->second;
+            Object* field = in.i_ptr->field(id);
+            if(field){
+                out = *field;
                 return true;
             }
 
+            ObjectDict_t::iterator it;
             std::vector<Class*> to_check {in.i_ptr->base};
             while(!to_check.empty()){
                 Class* base = to_check.back();
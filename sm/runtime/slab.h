@@ -0,0 +1,99 @@
+/*
+ *      Copyright 2016-2017 Riccardo Musso
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ *
+ *      File runtime/slab.h
+ *
+*/
+
+#ifndef _SM__RUNTIME__SLAB_H
+#define _SM__RUNTIME__SLAB_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sm{
+    namespace runtime{
+        /*
+         * Memory for objects of type Tp, in slabs of 'Count' slots.
+         * New objects take the last freed slot, else the next one of
+         * the last slab, so the ones made together are also near in
+         * memory. Slabs are given back only by the destructor (which
+         * doesn't destroy the objects left), so after a collection
+         * the freed slots are reused without asking the system.
+         * It doesn't lock anything.
+         */
+        template <typename Tp, size_t Count>
+        class Slabs {
+        private:
+            union Slot {
+                Slot* next; // when it's free
+                typename std::aligned_storage<sizeof(Tp), alignof(Tp)>::type data;
+            };
+
+            std::vector<std::unique_ptr<Slot[]>> _slabs;
+            Slot* _free = nullptr; // the freed slots
+            size_t _used = Count; // slots of the last slab given at least once
+
+            Slot* _take(){
+                if(_free){
+                    Slot* slot = _free;
+                    _free = slot->next;
+                    return slot;
+                }
+                if(_used == Count){
+                    _slabs.emplace_back(new Slot[Count]);
+                    _used = 0;
+                }
+                return &_slabs.back()[_used++];
+            }
+
+        public:
+            Slabs() = default;
+            Slabs(const Slabs&) = delete;
+            Slabs& operator=(const Slabs&) = delete;
+
+            template <typename... Args>
+            Tp* make(Args&&... args){
+                Slot* slot = _take();
+                try {
+                    return new (&slot->data) Tp(std::forward<Args>(args)...);
+                } catch(...){
+                    slot->next = _free;
+                    _free = slot;
+                    throw;
+                }
+            }
+
+            // 'ptr' must be made by make().
+            void destroy(Tp* ptr) noexcept{
+                ptr->~Tp();
+                Slot* slot = reinterpret_cast<Slot*>(ptr);
+                slot->next = _free;
+                _free = slot;
+            }
+
+            // bytes taken from the system.
+            size_t bytes() const noexcept{
+                return _slabs.size() * Count * sizeof(Slot);
+            }
+        };
+    }
+}
+
+#endif
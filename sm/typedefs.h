@@ -34,6 +34,7 @@
 #define _SM_DEFAULT_MAX_SS 100000
 #define _SM_DEFAULT_MIN_SS   1000
 #define _SM_DEFAULT_STACK_PRINTED_ELEMENTS 25
+#define _SM_SAMPLING_HZ 997 // not 1000, to avoid sampling in lockstep with periodic code
 
 /*
  * On Windows you can build a special
@@ -50,6 +51,16 @@
 #   define _SM_WINRES_CODE_ID 201
 #endif
 
+/*
+ * The interpreter dispatches instructions jumping directly
+ * to the address of the next handler (labels as values),
+ * when the compiler supports it. Define _SM_NO_THREADED_DISPATCH
+ * to fall back to the portable switch.
+ */
+#if defined(__GNUC__) && !defined(_SM_NO_THREADED_DISPATCH)
+#   define _SM_THREADED_DISPATCH
+#endif
+
 
 #   if defined(_WIN32) || defined(__CYGWIN__)
 #       if defined(_WIN64)
@@ -107,7 +118,12 @@ namespace sm{
     using IndexVector_t = std::vector<size_t>;
     using StringCharType_t = char;
 
-    constexpr unsigned garbageCollectorThreshold = 100;
+    constexpr unsigned garbageCollectorThreshold = 100; // minimum
+    constexpr unsigned garbageCollectorGrowth = 100; // % of the live instances
+    constexpr unsigned garbageCollectorNursery = 1000; // young instances
+    constexpr unsigned garbageCollectorBudget = 0; // microseconds of each step, 0 to collect at once
+    constexpr unsigned garbageCollectorStep = 100; // new instances between two steps
+    constexpr unsigned garbageCollectorSlab = 256; // instances of each slab
     constexpr unsigned uintMSB = 1u << (8 * sizeof(unsigned) -1);
     constexpr ascii_t fileSeparator =
     #ifdef _SM_OS_WINDOWS
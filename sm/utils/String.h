@@ -24,6 +24,8 @@
 #include "sm/typedefs.h"
 
 #include <vector>
+#include <algorithm>
+#include <type_traits>
 #include <ostream>
 #include <utility>
 #include <cstring>
@@ -180,6 +182,17 @@ namespace sm {
         static iterator find(iterator first, iterator last, const string<Tp, A>&);
         static const_iterator find(const_iterator first, const_iterator last, const string<Tp, A>&);
 
+        /*
+         * the first 'size' characters long match of 'str' in [first, last),
+         * 'last' if there's none. It looks for the first character with
+         * std::char_traits::find() (memchr() for char, which is vectorized
+         * by the C library), and compares the rest only where it's found.
+         */
+        static const value_type* search(const value_type* first, const value_type* last,
+            const value_type* str, size_type size) noexcept;
+        static const value_type* searchLast(const value_type* first, const value_type* last,
+            const value_type* str, size_type size) noexcept;
+
         static size_t uSize(const_iterator, const_iterator);
         static iterator nthChar(iterator, iterator, size_t);
 
@@ -572,6 +585,9 @@ namespace sm{
         const_iterator last (this->end());
         const_iterator lastInsertion (this->begin());
 
+        if(!strSize)
+            return *this;
+        ret.reserve(this->size());
         while((first = string<Tp, A>::find(first, last, str)) != last){
             ret.insert(ret.end(), lastInsertion, first);
             ret.insert(ret.end(), rep.begin(), rep.end());
@@ -588,10 +604,11 @@ namespace sm{
         const_iterator begin = this->begin();
         const_iterator end = this->end();
 
-        if((found = string<Tp, A>::find(begin, end, str)) != end){
+        if(!str.empty() && (found = string<Tp, A>::find(begin, end, str)) != end){
+            ret.reserve(this->size() - str.size() + rep.size());
             ret.assign(begin, found);
             ret.insert(ret.end(), rep.begin(), rep.end());
-            ret.insert(ret.end(), ++found, end);
+            ret.insert(ret.end(), found + str.size(), end);
         } else {
             ret = *this;
         }
@@ -610,19 +627,41 @@ namespace sm{
 
     template <class Tp, class A>
     std::vector<string<Tp, A>> string<Tp, A>::split(const string<Tp, A>& str, bool skipEmpty) const{
+        using UTp = typename std::make_unsigned<Tp>::type;
         std::vector<string<Tp, A>> vec;
         const_iterator last (this->begin());
         const_iterator it = last;
-        for(; it != this->end(); ++it){
-            for(const_iterator it2 = str.begin(); it2 != str.end(); ++it2){
-                if(*it == *it2){
+        const_iterator end = this->end();
+
+        if(str.size() == 1){
+            // a single separator: each one is found by find() (memchr() for char).
+            const value_type* begin = this->data();
+            const value_type* ptr;
+            while(it != end && (ptr = std::char_traits<Tp>::find(&*it, end - it, str[0])) != nullptr){
+                it = this->begin() + (ptr - begin);
+                if(!skipEmpty || last != it)
+                    vec.emplace_back(last, it);
+                last = ++it;
+            }
+            it = end;
+        } else if(sizeof(Tp) == 1){
+            // a table instead of comparing each character with all the separators.
+            bool separators[256] = {};
+            for(value_type ch : str)
+                separators[static_cast<UTp>(ch)] = true;
+            for(; it != end; ++it){
+                if(separators[static_cast<UTp>(*it)]){
                     if(!skipEmpty || last != it)
                         vec.emplace_back(last, it);
                     last = it+1;
-                    goto Continue;
                 }
             }
-            Continue: ;
+        } else {
+            while((it = std::find_first_of(it, end, str.begin(), str.end())) != end){
+                if(!skipEmpty || last != it)
+                    vec.emplace_back(last, it);
+                last = ++it;
+            }
         }
         if(!skipEmpty || last != it)
             vec.emplace_back(last, it);
@@ -631,23 +670,7 @@ namespace sm{
 
     template <class Tp, class A>
     std::vector<string<Tp, A>> string<Tp, A>::split(const value_type* str, bool skipEmpty) const{
-        std::vector<string<Tp, A>> vec;
-        const_iterator last (this->begin());
-        const_iterator it = last;
-        for(; it != this->end(); ++it){
-            for(const value_type* it2 = str; *it2; ++it2){
-                if(*it == *it2){
-                    if(!skipEmpty || last != it)
-                        vec.emplace_back(last, it);
-                    last = it+1;
-                    goto Continue;
-                }
-            }
-            Continue: ;
-        }
-        if(!skipEmpty || last != it)
-            vec.emplace_back(last, it);
-        return vec;
+        return split(string<Tp, A>(str), skipEmpty);
     }
 
     template <class Tp, class A>
@@ -828,68 +851,26 @@ namespace sm{
 
     template <class Tp, class A>
     typename string<Tp, A>::const_iterator string<Tp, A>::find(const string<Tp, A>& str) const{
-        size_t i = 0, strSize = str.size();
-        const_iterator it, found;
-        for(it = this->begin(); it != this->end(); ++it){
-            if(i == strSize){
-                return found;
-            } else if(*it == str[i]){
-                if(!i++)
-                    found = it;
-            } else {
-                i = 0;
-            }
-        }
-        return it;
+        return string<Tp, A>::find(this->begin(), this->end(), str);
     }
 
     template <class Tp, class A>
     typename string<Tp, A>::iterator string<Tp, A>::find(const string<Tp, A>& str){
-        size_t i = 0, strSize = str.size();
-        iterator it, found;
-        for(it = this->begin(); it != this->end(); ++it){
-            if(i == strSize){
-                return found;
-            } else if(*it == str[i]){
-                if(!i++)
-                    found = it;
-            } else {
-                i = 0;
-            }
-        }
-        return it;
+        return string<Tp, A>::find(this->begin(), this->end(), str);
     }
 
     template <class Tp, class A>
     typename string<Tp, A>::iterator string<Tp, A>::findLast(const string<Tp, A>& str){
-        size_t strSize = str.size(), i = strSize;
-        reverse_iterator it;
-        for(it = this->rbegin(); it != this->rend(); ++it){
-            if(!i){
-                return it.base();
-            } else if(*it == str[i-1]){
-                i--;
-            } else {
-                i = strSize;
-            }
-        }
-        return this->end();
+        const value_type* first = this->data();
+        const value_type* last = first + this->size();
+        return this->begin() + (searchLast(first, last, str.data(), str.size()) - first);
     }
 
     template <class Tp, class A>
     typename string<Tp, A>::const_iterator string<Tp, A>::findLast(const string<Tp, A>& str) const{
-        size_t strSize = str.size(), i = strSize;
-        const_reverse_iterator it;
-        for(it = this->rbegin(); it != this->rend(); ++it){
-            if(!i){
-                return it.base();
-            } else if(*it == str[i-1]){
-                i--;
-            } else {
-                i = strSize;
-            }
-        }
-        return this->end();
+        const value_type* first = this->data();
+        const value_type* last = first + this->size();
+        return this->begin() + (searchLast(first, last, str.data(), str.size()) - first);
     }
 
     template <class Tp, class A>
@@ -1006,28 +987,52 @@ namespace sm{
 
     template <class Tp, class A>
     typename string<Tp, A>::iterator string<Tp, A>::find(iterator first, iterator last, const string<Tp, A>& str){
-        size_t i = 0, size = str.size();
-        while(first != last){
-            if(*first == str[i]){
-                if(++i == size){
-                    return first - (i-1);
-                }
-            }
-            ++first;
+        if(first == last)
+            return last;
+        const value_type* begin = &*first;
+        return first + (search(begin, begin + (last - first), str.data(), str.size()) - begin);
+    }
+
+    template <class Tp, class A>
+    typename string<Tp, A>::const_iterator string<Tp, A>::find(const_iterator first, const_iterator last, const string<Tp, A>& str){
+        if(first == last)
+            return last;
+        const value_type* begin = &*first;
+        return first + (search(begin, begin + (last - first), str.data(), str.size()) - begin);
+    }
+
+    template <class Tp, class A>
+    const typename string<Tp, A>::value_type* string<Tp, A>::search(const value_type* first,
+            const value_type* last, const value_type* str, size_type size) noexcept{
+        using Traits = std::char_traits<Tp>;
+        if(!size)
+            return first;
+        if(static_cast<size_type>(last - first) < size)
+            return last;
+
+        const value_type* end = last - size + 1; // after the last possible start
+        while((first = Traits::find(first, end - first, str[0])) != nullptr){
+            if(!Traits::compare(first + 1, str + 1, size - 1))
+                return first;
+            if(++first == end)
+                break;
         }
         return last;
     }
 
     template <class Tp, class A>
-    typename string<Tp, A>::const_iterator string<Tp, A>::find(const_iterator first, const_iterator last, const string<Tp, A>& str){
-        size_t i = 0, size = str.size();
-        while(first != last){
-            if(*first == str[i]){
-                if(++i == size){
-                    return first - (i-1);
-                }
-            }
-            ++first;
+    const typename string<Tp, A>::value_type* string<Tp, A>::searchLast(const value_type* first,
+            const value_type* last, const value_type* str, size_type size) noexcept{
+        using Traits = std::char_traits<Tp>;
+        if(!size)
+            return last;
+        if(static_cast<size_type>(last - first) < size)
+            return last;
+
+        for(const value_type* it = last - size + 1; it != first;){
+            --it;
+            if(Traits::eq(*it, str[0]) && !Traits::compare(it + 1, str + 1, size - 1))
+                return it;
         }
         return last;
     }
@@ -0,0 +1,69 @@
+#!/bin/sh
+#
+# Regression tests: each script prints "ok" when it passes.
+# A line '// options: <options>' in a script adds <options>
+# to the command line; with lines '// expect: <text>' the script
+# passes if its output contains each <text> instead (e.g. errors).
+# Each script is run from its directory, then again from the SMK
+# file made by -c.
+# Usage: tests/run.sh [smudge executable, default ./smudge]
+#
+
+SMUDGE=${1:-./smudge}
+case "$SMUDGE" in
+    /*) ;;
+    *) SMUDGE=$(pwd)/$SMUDGE ;;
+esac
+DIR=$(dirname "$0")
+SMK=$(mktemp -d)
+trap 'rm -rf "$SMK"' EXIT
+failed=0
+
+# passed <script> <output> <exit status>
+passed(){
+    expect=$(sed -n 's|^// expect: ||p' "$1")
+    if [ -z "$expect" ]; then
+        [ "$3" -eq 0 ] && [ "$(printf '%s\n' "$2" | tail -n 1)" = "ok" ]
+    else
+        printf '%s\n' "$expect" | while IFS= read -r line; do
+            printf '%s\n' "$2" | grep -qF -- "$line" || exit 1
+        done
+    fi
+}
+
+# report <name> <script> <output> <exit status>
+report(){
+    if passed "$2" "$3" "$4"; then
+        echo "PASS: $1"
+    else
+        echo "FAIL: $1"
+        printf '%s\n' "$3" | sed 's/^/    /'
+        failed=$((failed + 1))
+    fi
+}
+
+for test in "$DIR"/*.sm; do
+    name=$(basename "$test")
+    opts=$(sed -n 's|^// options: ||p' "$test")
+    out=$(cd "$DIR" && "$SMUDGE" $opts "$name" 2>&1)
+    report "$name" "$test" "$out" $?
+
+    cp "$test" "$SMK/"
+    out=$(cd "$SMK" && "$SMUDGE" -c "$name" 2>&1 && "$SMUDGE" $opts -I "${name}k" 2>&1)
+    report "$name (SMK)" "$test" "$out" $?
+done
+
+# bad values of the options print the usage instead of running.
+for opts in "-b -1" "-b -M" "-b 99999999999" "-g 0" "-g -5" "-g" "-G -1" "-G -M" \
+        "-G 99999999999"; do
+    out=$("$SMUDGE" $opts "$DIR/order.sm" 2>&1)
+    if printf '%s\n' "$out" | grep -q '^Usage:'; then
+        echo "PASS: usage with $opts"
+    else
+        echo "FAIL: usage with $opts"
+        printf '%s\n' "$out" | sed 's/^/    /'
+        failed=$((failed + 1))
+    fi
+done
+
+[ $failed -eq 0 ]